@@ -0,0 +1,325 @@
+// bench/store_bench.cpp
+// ЗАМЕРЫ ПРОИЗВОДИТЕЛЬНОСТИ (Google Benchmark)
+//
+// Микрозамеры работают без БД. Замеры с БД (BM_Db*) выполняются, только
+// если задана переменная STORE_BENCH_DSN со строкой подключения к локальной
+// заполненной базе (sql/database_setup.sql); иначе они пропускаются.
+// Замеры с БД создают и меняют заказы - не запускайте их на рабочей базе.
+//
+// Результат для сравнения версий:
+//   ./store_bench --benchmark_out=bench.json --benchmark_out_format=json
+//   compare.py benchmarks old.json new.json   (из tools/ Google Benchmark)
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "../include/DatabaseConnection.h"
+#include "../include/Logger.h"
+#include "../include/Order.h"
+#include "../include/OrderColumns.h"
+#include "../include/TablePrinter.h"
+#include "../include/User.h"
+
+namespace {
+
+// Поток вывода, который ничего не пишет: замеряется только форматирование
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+const OrderStatus BENCH_STATUSES[] = {
+    OrderStatus::Pending, OrderStatus::Processing, OrderStatus::Completed,
+    OrderStatus::Canceled, OrderStatus::Returned
+};
+
+std::vector<std::shared_ptr<Order>> makeOrders(std::size_t count) {
+    std::vector<std::shared_ptr<Order>> orders;
+    orders.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        orders.push_back(std::make_shared<Order>(
+            static_cast<int>(i + 1), static_cast<int>(i % 97 + 1),
+            BENCH_STATUSES[i % ORDER_STATUS_COUNT],
+            Money::fromCents(static_cast<std::int64_t>(i % 10000) * 100 + 99)));
+    }
+    return orders;
+}
+
+} // namespace
+
+//  МИКРОЗАМЕРЫ
+
+static void BM_OrderCalculateTotal(benchmark::State& state) {
+    Order order(1, 1, OrderStatus::Pending, Money());
+    for (int i = 0; i < state.range(0); ++i) {
+        order.addItem(i + 1, i + 1, "Товар " + std::to_string(i), i % 5 + 1,
+                      Money::fromCents(1999 + i));
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(order.calculateTotal());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_OrderCalculateTotal)->RangeMultiplier(8)->Range(8, 4096);
+
+static void BM_FilterOrdersByStatus(benchmark::State& state) {
+    auto orders = makeOrders(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        auto filtered = Order::filterOrdersByStatus(orders, OrderStatus::Completed);
+        benchmark::DoNotOptimize(filtered.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FilterOrdersByStatus)->RangeMultiplier(10)->Range(1000, 1000000);
+
+static void BM_CountOrdersByStatus(benchmark::State& state) {
+    auto orders = makeOrders(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Order::countOrdersByStatus(orders, OrderStatus::Completed));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CountOrdersByStatus)->RangeMultiplier(10)->Range(1000, 1000000);
+
+// Тот же подсчет по колоночному снимку (для сравнения с BM_CountOrdersByStatus)
+static void BM_OrderColumnsCountByStatus(benchmark::State& state) {
+    OrderColumns columns;
+    columns.reserve(static_cast<std::size_t>(state.range(0)));
+    for (int i = 0; i < state.range(0); ++i) {
+        columns.append(i + 1, i % 97 + 1, BENCH_STATUSES[i % ORDER_STATUS_COUNT],
+                       Money::fromCents(static_cast<std::int64_t>(i % 10000) * 100 + 99), 0);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(columns.countByStatus(OrderStatus::Completed));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_OrderColumnsCountByStatus)->RangeMultiplier(10)->Range(1000, 1000000);
+
+// generateTransactionId закрыт, он вызывается из конструктора Payment
+static void BM_PaymentTransactionId(benchmark::State& state) {
+    for (auto _ : state) {
+        Payment payment(Money::fromCents(10000), nullptr);
+        benchmark::DoNotOptimize(payment.getTransactionId().data());
+    }
+}
+BENCHMARK(BM_PaymentTransactionId);
+
+static void BM_PrintTable(benchmark::State& state) {
+    std::vector<std::vector<std::string>> data;
+    for (int i = 0; i < state.range(0); ++i) {
+        data.push_back({std::to_string(i + 1), "Покупатель " + std::to_string(i % 50),
+                        Money::fromCents(i * 137).toString(), "2026-01-15 10:32:45",
+                        std::to_string(i % 7 + 1)});
+    }
+    const std::vector<std::string> headers = {"ID заказа", "Клиент", "Сумма", "Дата", "Товаров"};
+
+    NullBuffer buffer;
+    std::ostream out(&buffer);
+
+    for (auto _ : state) {
+        printTable(data, headers, out);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PrintTable)->RangeMultiplier(10)->Range(10, 10000);
+
+//  ЗАМЕРЫ С БД
+
+namespace {
+
+// Общее подключение и пользователи всех ролей (создаются один раз)
+struct BenchDatabase {
+    std::shared_ptr<DatabaseConnection<std::string>> db;
+    std::shared_ptr<Customer> customer;
+    std::shared_ptr<Manager> manager;
+    std::shared_ptr<Admin> admin;
+    std::vector<std::pair<int, int>> cart;   // Один товар с большим остатком
+    std::string error;
+
+    // Сколько добавлено к остатку товара (возвращается в деструкторе)
+    static constexpr int STOCK_RESERVE = 1000000;
+    int reservedProductId = 0;
+
+    BenchDatabase() {
+        const char* dsn = std::getenv("STORE_BENCH_DSN");
+        if (!dsn) {
+            error = "STORE_BENCH_DSN не задана";
+            return;
+        }
+
+        PoolOptions options;
+        options.initialSize = 2;
+        options.maxSize = 4;
+        db = std::make_shared<DatabaseConnection<std::string>>(dsn, options);
+        if (!db->isConnected()) {
+            error = "Нет подключения к БД";
+            return;
+        }
+        User::registerStatements(*db);
+
+        auto customers = db->query<int, std::string, std::string, int>(
+            "SELECT user_id, name, email, loyalty_level FROM users WHERE role = 'customer' LIMIT 1");
+        auto managers = db->query<int, std::string, std::string>(
+            "SELECT user_id, name, email FROM users WHERE role = 'manager' LIMIT 1");
+        auto admins = db->query<int, std::string, std::string>(
+            "SELECT user_id, name, email FROM users WHERE role = 'admin' LIMIT 1");
+        if (customers.empty() || managers.empty() || admins.empty()) {
+            error = "В БД нет пользователей всех ролей";
+            return;
+        }
+
+        auto [customerId, customerName, customerEmail, loyalty] = customers[0];
+        customer = std::make_shared<Customer>(customerId, customerName, customerEmail, loyalty, db);
+        auto [managerId, managerName, managerEmail] = managers[0];
+        manager = std::make_shared<Manager>(managerId, managerName, managerEmail, db);
+        auto [adminId, adminName, adminEmail] = admins[0];
+        admin = std::make_shared<Admin>(adminId, adminName, adminEmail, db);
+
+        // Товар с запасом, чтобы остаток не кончился за время замера
+        auto products = db->query<int>(
+            "UPDATE products SET stock_quantity = stock_quantity + " +
+            std::to_string(STOCK_RESERVE) +
+            " WHERE product_id = (SELECT product_id FROM products ORDER BY product_id LIMIT 1) "
+            "RETURNING product_id");
+        if (products.empty()) {
+            error = "В БД нет товаров";
+            return;
+        }
+        reservedProductId = std::get<0>(products[0]);
+        cart.emplace_back(reservedProductId, 1);
+    }
+
+    // Запас остатка снимается, чтобы повторные запуски не накапливали его.
+    // Товар, списанный утвержденными заказами замеров, остается списанным
+    ~BenchDatabase() {
+        if (reservedProductId != 0) {
+            db->executeNonQuery(
+                "UPDATE products SET stock_quantity = GREATEST(stock_quantity - " +
+                std::to_string(STOCK_RESERVE) + ", 0) WHERE product_id = " +
+                std::to_string(reservedProductId));
+        }
+    }
+
+    // Последний заказ покупателя (0 - заказов нет или ошибка)
+    int lastOrderId() {
+        auto result = db->query<std::optional<int>>(
+            "SELECT MAX(order_id) FROM orders WHERE user_id = " +
+            std::to_string(customer->getUserId()));
+        return result.empty() ? 0 : std::get<0>(result[0]).value_or(0);
+    }
+
+    // Создает заказ покупателя и возвращает его ID (0 - заказ не создан)
+    int createPendingOrder() {
+        int before = lastOrderId();
+        customer->createOrder(cart);
+        int after = lastOrderId();
+        return after > before ? after : 0;
+    }
+};
+
+BenchDatabase* benchDatabase(benchmark::State& state) {
+    static BenchDatabase database;
+    if (!database.error.empty()) {
+        state.SkipWithError(database.error.c_str());
+        return nullptr;
+    }
+    return &database;
+}
+
+} // namespace
+
+static void BM_DbCustomerCreateOrder(benchmark::State& state) {
+    BenchDatabase* bench = benchDatabase(state);
+    if (!bench) {
+        return;
+    }
+
+    int lastOrderId = bench->lastOrderId();
+
+    for (auto _ : state) {
+        bench->customer->createOrder(bench->cart);
+
+        // Проверка вне замера: неудачная вставка не должна считаться заказом
+        state.PauseTiming();
+        int orderId = bench->lastOrderId();
+        bool created = orderId > lastOrderId;
+        lastOrderId = orderId;
+        state.ResumeTiming();
+
+        if (!created) {
+            state.SkipWithError("Заказ не создан");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_DbCustomerCreateOrder)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_DbManagerApproveOrder(benchmark::State& state) {
+    BenchDatabase* bench = benchDatabase(state);
+    if (!bench) {
+        return;
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        int orderId = bench->createPendingOrder();
+        state.ResumeTiming();
+
+        if (orderId == 0) {
+            state.SkipWithError("Заказ не создан");
+            break;
+        }
+
+        if (!bench->manager->approveOrder(orderId)) {
+            state.SkipWithError("Заказ не утвержден");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_DbManagerApproveOrder)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_DbAdminCancelOrder(benchmark::State& state) {
+    BenchDatabase* bench = benchDatabase(state);
+    if (!bench) {
+        return;
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        int orderId = bench->createPendingOrder();
+        state.ResumeTiming();
+
+        if (orderId == 0) {
+            state.SkipWithError("Заказ не создан");
+            break;
+        }
+
+        if (!bench->admin->cancelOrder(orderId)) {
+            state.SkipWithError("Заказ не отменен");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_DbAdminCancelOrder)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char** argv) {
+    // Сообщения об успешных операциях не нужны и искажают замеры
+    Logger::instance().setLevel(LogLevel::Warning);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
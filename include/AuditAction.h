@@ -0,0 +1,39 @@
+// include/AuditAction.h
+#ifndef AUDITACTION_H
+#define AUDITACTION_H
+
+#include <array>         // Для таблицы имен
+#include <cstdint>       // Для uint8_t
+#include <string_view>   // Для имен действий
+
+// ДЕЙСТВИЕ АУДИТА
+// Совпадает с типом audit_action в БД (audit_log.action): по нему
+// выборки из журнала идут по индексу, а не по тексту details.
+enum class AuditAction : std::uint8_t {
+    OrderCreated = 0,
+    OrderApproved = 1,
+    OrderCanceled = 2,
+    OrderReturned = 3,
+    OrderStatusChanged = 4,
+    OrderError = 5,
+    ProductCreated = 6,
+    ProductUpdated = 7,
+    ProductDeleted = 8,
+    StockUpdated = 9,
+    UserDeleted = 10
+};
+
+constexpr std::size_t AUDIT_ACTION_COUNT = 11;
+
+// Имена значений audit_action в БД
+constexpr std::array<std::string_view, AUDIT_ACTION_COUNT> AUDIT_ACTION_NAMES = {
+    "order_created", "order_approved", "order_canceled", "order_returned",
+    "order_status_changed", "order_error", "product_created", "product_updated",
+    "product_deleted", "stock_updated", "user_deleted"
+};
+
+constexpr std::string_view toString(AuditAction action) {
+    return AUDIT_ACTION_NAMES[static_cast<std::size_t>(action)];
+}
+
+#endif // AUDITACTION_H
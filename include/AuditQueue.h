@@ -0,0 +1,100 @@
+// include/AuditQueue.h
+#ifndef AUDITQUEUE_H
+#define AUDITQUEUE_H
+
+#include <chrono>               // Для времени события и интервала сброса
+#include <condition_variable>   // Для ожидания потока записи
+#include <cstdint>              // Для номеров событий
+#include <future>               // Для подтверждения записи в режиме Sync
+#include <memory>               // Для умных указателей
+#include <mutex>                // Для защиты очереди
+#include <optional>             // Для entity_id без значения
+#include <string>               // Для строк
+#include <thread>               // Для фонового потока
+#include <vector>               // Для пакета событий
+#include "AuditAction.h"        // Для кода действия
+
+template<typename T> class DatabaseConnection;
+
+// СОБЫТИЕ АУДИТА (одна строка audit_log)
+struct AuditEvent {
+    std::string entityType;
+    std::optional<int> entityId;
+    std::string operation;
+    AuditAction action = AuditAction::OrderStatusChanged;
+    int performedBy = 0;
+    std::string details;
+    std::optional<std::string> payload;   // JSON-объект (audit_log.payload)
+    // Время операции, а не записи в БД
+    std::chrono::system_clock::time_point performedAt = std::chrono::system_clock::now();
+};
+
+// РЕЖИМ НАДЕЖНОСТИ
+enum class AuditDurability {
+    Async,  // enqueue возвращается сразу; при аварии теряются события последнего интервала
+    Sync    // enqueue ждет коммита своего пакета (групповой коммит)
+};
+
+// НАСТРОЙКИ ОЧЕРЕДИ АУДИТА
+struct AuditQueueOptions {
+    AuditDurability durability = AuditDurability::Async;
+    std::size_t batchSize = 256;                         // Событий в одном INSERT
+    std::size_t capacity = 65536;                        // Предел очереди
+    std::chrono::milliseconds flushInterval{200};        // Максимальная задержка записи
+};
+
+// ОЧЕРЕДЬ АУДИТА
+// Бизнес-операции только кладут событие в очередь, фоновый поток
+// записывает накопленные события пакетами: один многострочный INSERT
+// (unnest массивов) и один коммит на пакет. В режиме Sync параллельные
+// вызовы ждут общий коммит, поэтому пропускная способность растет
+// вместе с числом потоков.
+class AuditQueue {
+public:
+    explicit AuditQueue(std::shared_ptr<DatabaseConnection<std::string>> db,
+                        const AuditQueueOptions& options = AuditQueueOptions());
+
+    // Запрещаем копирование
+    AuditQueue(const AuditQueue&) = delete;
+    AuditQueue& operator=(const AuditQueue&) = delete;
+
+    // Записывает оставшиеся события и останавливает поток
+    ~AuditQueue();
+
+    // Поставить событие в очередь. Если очередь полна, ждет места.
+    // Async: true - событие принято. Sync: true - событие записано в БД.
+    bool enqueue(AuditEvent event);
+
+    // Дождаться записи всех событий, поставленных до вызова
+    void flush();
+
+    AuditDurability getDurability() const { return options.durability; }
+    std::size_t getPendingCount() const;
+    std::size_t getFailedCount() const;
+
+private:
+    struct Entry {
+        AuditEvent event;
+        std::promise<bool>* written = nullptr;   // Ожидающий вызов в режиме Sync
+    };
+
+    std::shared_ptr<DatabaseConnection<std::string>> db;
+    AuditQueueOptions options;
+
+    mutable std::mutex queueMutex;
+    std::condition_variable workCondition;       // Появились события / остановка
+    std::condition_variable spaceCondition;      // Освободилось место
+    std::condition_variable flushedCondition;    // Пакет записан
+    std::vector<Entry> pending;
+    std::uint64_t enqueuedCount = 0;
+    std::uint64_t writtenCount = 0;
+    std::size_t failedCount = 0;
+    bool flushRequested = false;
+    bool stopping = false;
+    std::thread worker;
+
+    void workerLoop();
+    bool writeBatch(const std::vector<Entry>& batch, std::size_t begin, std::size_t end);
+};
+
+#endif // AUDITQUEUE_H
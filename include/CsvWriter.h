@@ -0,0 +1,58 @@
+// include/CsvWriter.h
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+
+#include <fstream>            // Для записи в файл
+#include <string>             // Для строк
+#include <string_view>        // Для полей без копирования
+#include <initializer_list>   // Для writeRow
+
+// БУФЕРИЗОВАННАЯ ЗАПИСЬ CSV
+// Поля копируются в собственный буфер и сбрасываются в файл крупными
+// блоками, поэтому память не зависит от размера отчета.
+// Поля экранируются по RFC 4180: поле с разделителем, кавычкой или
+// переводом строки берется в кавычки, кавычки внутри удваиваются.
+// Данные пишутся во временный файл и переименовываются в close(),
+// поэтому недописанный отчет не заменяет предыдущий.
+class CsvWriter {
+private:
+    std::string filename;
+    std::string tempFilename;
+    std::ofstream file;
+    std::string buffer;
+    std::size_t bufferSize;
+    char delimiter;
+    bool rowStarted = false;
+    bool closed = false;
+    std::size_t rowCount = 0;
+
+    void appendEscaped(std::string_view field);
+    bool flushBuffer();
+
+public:
+    explicit CsvWriter(const std::string& filename, char delimiter = ';',
+                       std::size_t bufferSize = 64 * 1024);
+
+    // Запрещаем копирование
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    // Без close() временный файл удаляется
+    ~CsvWriter();
+
+    bool isOpen() const { return file.is_open(); }
+
+    // Запись по полям: writeField(...) ... endRow()
+    void writeField(std::string_view field);
+    void endRow();
+
+    // Запись строки целиком
+    void writeRow(std::initializer_list<std::string_view> fields);
+
+    // Сбросить буфер и переименовать файл. true - отчет записан
+    bool close();
+
+    std::size_t getRowCount() const { return rowCount; }
+};
+
+#endif // CSVWRITER_H
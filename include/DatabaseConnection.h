@@ -2,105 +2,768 @@
 #ifndef DATABASECONNECTION_H
 #define DATABASECONNECTION_H
 
-#include <pqxx/pqxx>      // Библиотека для PostgreSQL
-#include <memory>         // Для умных указателей
-#include <vector>         // Для контейнеров
-#include <string>         // Для строк
-#include <iostream>       // Для вывода
-#include <stdexcept>      // Для исключений
+#include <pqxx/pqxx>             // Библиотека для PostgreSQL
+#include <memory>                // Для умных указателей
+#include <vector>                // Для контейнеров
+#include <string>                // Для строк
+#include <stdexcept>             // Для исключений
+#include <algorithm>             // Для std::min/std::max
+#include <map>                   // Для транзакций по потокам
+#include <mutex>                 // Для синхронизации пула
+#include <condition_variable>    // Для ожидания свободного соединения
+#include <chrono>                // Для таймаутов
+#include <thread>                // Для std::this_thread::get_id
+#include <atomic>                // Для счетчика курсоров
+#include <functional>            // Для обработчиков строк
+#include <tuple>                 // Для типизированных строк
+#include <optional>              // Для NULL-значений
+#include <string_view>           // Для текста без копирования
+#include <utility>               // Для std::index_sequence
+#include "Logger.h"              // Асинхронный лог
+#include "Money.h"               // Денежные суммы (NUMERIC)
+#include "OrderStatus.h"         // Статус заказа
+
+// ПРЕОБРАЗОВАНИЕ Money <-> NUMERIC для libpqxx
+// Позволяет передавать Money параметром запроса и читать field.as<Money>():
+// сумма пишется и разбирается в текстовом виде NUMERIC, без double.
+namespace pqxx {
+    template<>
+    struct nullness<Money> : no_null<Money> {};
+
+    template<>
+    struct string_traits<Money> {
+        static constexpr bool converts_to_string{true};
+        static constexpr bool converts_from_string{true};
+
+        static Money from_string(std::string_view text) {
+            auto value = Money::parse(text);
+            if (!value) {
+                throw conversion_error("Некорректная сумма: " + std::string(text));
+            }
+            return *value;
+        }
+
+        static char* into_buf(char* begin, char* end, const Money& value) {
+            if (end - begin < static_cast<std::ptrdiff_t>(Money::MAX_TEXT + 1)) {
+                throw conversion_overrun("Недостаточно места для суммы");
+            }
+            char* stop = begin + value.format(begin);
+            *stop = '\0';
+            return stop + 1;
+        }
+
+        static zview to_buf(char* begin, char* end, const Money& value) {
+            char* stop = into_buf(begin, end, value);
+            return zview(begin, static_cast<std::size_t>(stop - begin - 1));
+        }
+
+        static std::size_t size_buffer(const Money&) noexcept {
+            return Money::MAX_TEXT + 1;
+        }
+    };
+}
+
+// ПАРАМЕТРЫ ПУЛА СОЕДИНЕНИЙ
+struct PoolOptions {
+    std::size_t initialSize = 1;                  // Сколько соединений открыть сразу
+    std::size_t maxSize = 4;                      // Максимальный размер пула
+    std::chrono::milliseconds waitTimeout{5000};  // Сколько ждать свободное соединение
+    bool validateOnCheckout = true;               // Проверять соединение перед выдачей
+    std::chrono::milliseconds pingAfterIdle{30000}; // Простоявшее дольше проверяется запросом
+};
+
+// ДЕКОДИРОВАНИЕ ПОЛЕЙ
+// Поле читается прямо из буфера libpq, без промежуточной std::string.
+template<typename U>
+struct FieldDecoder {
+    static U decode(const pqxx::field& field) {
+        return field.as<U>();
+    }
+};
+
+// Текст без копирования: string_view указывает в буфер результата
+template<>
+struct FieldDecoder<std::string_view> {
+    static std::string_view decode(const pqxx::field& field) {
+        return std::string_view(field.c_str(), field.size());
+    }
+};
+
+// NUMERIC -> Money: разбор прямо из буфера результата
+template<>
+struct FieldDecoder<Money> {
+    static Money decode(const pqxx::field& field) {
+        return pqxx::string_traits<Money>::from_string(std::string_view(field.c_str(), field.size()));
+    }
+};
+
+// orders.status -> OrderStatus
+template<>
+struct FieldDecoder<OrderStatus> {
+    static OrderStatus decode(const pqxx::field& field) {
+        auto status = parseOrderStatus(std::string_view(field.c_str(), field.size()));
+        if (!status) {
+            throw pqxx::conversion_error("Неизвестный статус заказа: " + std::string(field.c_str()));
+        }
+        return *status;
+    }
+};
+
+// NULL -> std::nullopt
+template<typename U>
+struct FieldDecoder<std::optional<U>> {
+    static std::optional<U> decode(const pqxx::field& field) {
+        if (field.is_null()) {
+            return std::nullopt;
+        }
+        return FieldDecoder<U>::decode(field);
+    }
+};
+
+// ТИПИЗИРОВАННЫЙ РЕЗУЛЬТАТ ЗАПРОСА
+// Владеет pqxx::result и декодирует строки в std::tuple<Ts...> по запросу.
+// Значения std::string_view действительны, пока жив этот объект.
+template<typename... Ts>
+class TypedResult {
+private:
+    pqxx::result res;
+
+    template<std::size_t... I>
+    std::tuple<Ts...> decodeRow(const pqxx::row& row, std::index_sequence<I...>) const {
+        return std::tuple<Ts...>(FieldDecoder<Ts>::decode(row[I])...);
+    }
+
+public:
+    using value_type = std::tuple<Ts...>;
+
+    // Итератор по строкам (декодирует строку при разыменовании)
+    class const_iterator {
+    private:
+        const TypedResult* owner;
+        std::size_t index;
+
+    public:
+        const_iterator(const TypedResult* result, std::size_t i) : owner(result), index(i) {}
+
+        value_type operator*() const { return (*owner)[index]; }
+        const_iterator& operator++() { ++index; return *this; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+    };
+
+    TypedResult() = default;
+    explicit TypedResult(pqxx::result r) : res(std::move(r)) {}
+
+    std::size_t size() const { return res.size(); }
+    bool empty() const { return res.empty(); }
+
+    value_type operator[](std::size_t i) const {
+        const pqxx::row row = res[i];
+        if (row.size() < sizeof...(Ts)) {
+            throw std::out_of_range("В строке результата меньше колонок, чем запрошено");
+        }
+        return decodeRow(row, std::index_sequence_for<Ts...>{});
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+};
 
 // ШАБЛОННЫЙ КЛАСС DatabaseConnection<T>
+// Держит пул заранее открытых соединений. Каждая операция берет
+// соединение из пула и возвращает его обратно, поэтому объект можно
+// разделять между пользователями и потоками через shared_ptr.
 template<typename T>
 class DatabaseConnection {
 private:
-    //  УМНЫЕ УКАЗАТЕЛИ
-    std::unique_ptr<pqxx::connection> conn;          // unique_ptr - единоличное владение
-    std::unique_ptr<pqxx::work> currentTransaction;  // Текущая транзакция
+    // Элемент пула: соединение и число уже подготовленных на нем запросов
+    struct PoolEntry {
+        pqxx::connection conn;
+        std::size_t preparedCount = 0;
+        std::chrono::steady_clock::time_point lastUsed = std::chrono::steady_clock::now();
+
+        explicit PoolEntry(const T& connectionString) : conn(connectionString) {}
+    };
 
 public:
-    //КОНСТРУКТОР
-    explicit DatabaseConnection(const T& connectionString) {
+    // СОЕДИНЕНИЕ, ВЗЯТОЕ ИЗ ПУЛА
+    // Возвращается в пул автоматически в деструкторе (RAII).
+    // Пул должен жить дольше, чем выданные из него соединения.
+    class PooledConnection {
+    private:
+        friend class DatabaseConnection;
+
+        DatabaseConnection* owner = nullptr;
+        std::unique_ptr<PoolEntry> conn;
+
+    public:
+        PooledConnection() = default;
+        PooledConnection(DatabaseConnection* pool, std::unique_ptr<PoolEntry> c)
+            : owner(pool), conn(std::move(c)) {}
+
+        // Запрещаем копирование
+        PooledConnection(const PooledConnection&) = delete;
+        PooledConnection& operator=(const PooledConnection&) = delete;
+
+        // Разрешаем перемещение
+        PooledConnection(PooledConnection&& other) noexcept
+            : owner(other.owner), conn(std::move(other.conn)) {
+            other.owner = nullptr;
+        }
+
+        PooledConnection& operator=(PooledConnection&& other) noexcept {
+            if (this != &other) {
+                release();
+                owner = other.owner;
+                conn = std::move(other.conn);
+                other.owner = nullptr;
+            }
+            return *this;
+        }
+
+        ~PooledConnection() { release(); }
+
+        pqxx::connection& operator*() const { return conn->conn; }
+        pqxx::connection* operator->() const { return &conn->conn; }
+        explicit operator bool() const { return static_cast<bool>(conn); }
+
+        // Досрочный возврат соединения в пул
+        void release() {
+            if (owner && conn) {
+                owner->returnConnection(std::move(conn));
+            }
+            owner = nullptr;
+        }
+    };
+
+private:
+    T connectionString;
+    PoolOptions options;
+
+    //  ПУЛ: свободные соединения и счетчик всех открытых
+    std::vector<std::unique_ptr<PoolEntry>> idle;
+    std::size_t openCount = 0;
+    bool closing = false;
+    mutable std::mutex poolMutex;
+    std::condition_variable poolCondition;
+
+    //  РЕЕСТР ПОДГОТОВЛЕННЫХ ЗАПРОСОВ (имя -> SQL)
+    // Только дополняется, поэтому соединению достаточно помнить,
+    // сколько первых запросов реестра оно уже подготовило.
+    std::vector<std::pair<std::string, std::string>> statements;
+    mutable std::mutex statementMutex;
+
+    // Счетчик для уникальных имен серверных курсоров
+    std::atomic<std::size_t> cursorCounter{0};
+
+    //  ТРАНЗАКЦИИ: у каждого потока своя транзакция на своем соединении
+    struct ActiveTransaction {
+        PooledConnection connection;            // Уничтожается последним
+        std::unique_ptr<pqxx::work> work;       // Текущая транзакция
+    };
+    std::map<std::thread::id, ActiveTransaction> transactions;
+    mutable std::mutex transactionMutex;
+
+    // Открытие нового соединения
+    std::unique_ptr<PoolEntry> openConnection() {
+        auto c = std::make_unique<PoolEntry>(connectionString);
+        if (!c->conn.is_open()) {
+            throw std::runtime_error("Не удалось открыть соединение");
+        }
+        return c;
+    }
+
+    // Проверка соединения перед выдачей.
+    // is_open() - это PQstatus() == CONNECTION_OK, то есть состояние после
+    // последней операции: разрыв со стороны сервера он не замечает. Поэтому
+    // соединение, простоявшее дольше pingAfterIdle, проверяется запросом.
+    bool isAlive(PoolEntry& entry) const {
+        if (!entry.conn.is_open()) {
+            return false;
+        }
+        if (std::chrono::steady_clock::now() - entry.lastUsed < options.pingAfterIdle) {
+            return true;
+        }
         try {
-            // Создаем подключение с помощью unique_ptr
-            conn = std::make_unique<pqxx::connection>(connectionString);
+            pqxx::nontransaction ntx(entry.conn);
+            ntx.exec("SELECT 1");
+            return true;
+        } catch (const std::exception& e) {
+            LOG_WARNING("Соединение не отвечает: " << e.what());
+            return false;
+        }
+    }
+
+    // Подготовка на соединении запросов, зарегистрированных после его открытия
+    void prepareStatements(PoolEntry& entry) {
+        std::vector<std::pair<std::string, std::string>> missing;
+        {
+            std::lock_guard<std::mutex> lock(statementMutex);
+            if (entry.preparedCount >= statements.size()) {
+                return;
+            }
+            missing.assign(statements.begin() + entry.preparedCount, statements.end());
+        }
+
+        for (const auto& statement : missing) {
+            entry.conn.prepare(statement.first, statement.second);
+            ++entry.preparedCount;
+        }
+    }
 
-            if (conn->is_open()) {
-                std::cout << "Подключено к БД: " << conn->dbname() << std::endl;
+    // Преобразование результата в вектор строк
+    static std::vector<std::vector<std::string>> toRows(const pqxx::result& res) {
+        std::vector<std::vector<std::string>> results;
+        results.reserve(res.size());
+        for (const auto& row : res) {
+            std::vector<std::string> rowData;
+            rowData.reserve(row.size());
+            for (const auto& field : row) {
+                rowData.emplace_back(field.c_str(), field.size());
+            }
+            results.push_back(std::move(rowData));
+        }
+        return results;
+    }
+
+    // Возврат соединения в пул (вызывается из PooledConnection)
+    void returnConnection(std::unique_ptr<PoolEntry> c) {
+        std::unique_ptr<PoolEntry> broken;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (c && c->conn.is_open() && !closing) {
+                c->lastUsed = std::chrono::steady_clock::now();
+                idle.push_back(std::move(c));
             } else {
-                throw std::runtime_error("Не удалось открыть соединение");
+                // Разорванное соединение не возвращаем, освобождаем место
+                broken = std::move(c);
+                --openCount;
+            }
+        }
+        poolCondition.notify_one();
+    }
+
+    // Извлечение транзакции текущего потока
+    std::unique_ptr<ActiveTransaction> takeTransaction() {
+        std::lock_guard<std::mutex> lock(transactionMutex);
+        auto it = transactions.find(std::this_thread::get_id());
+        if (it == transactions.end()) {
+            return nullptr;
+        }
+        auto tx = std::make_unique<ActiveTransaction>(std::move(it->second));
+        transactions.erase(it);
+        return tx;
+    }
+
+    // Транзакция текущего потока или nullptr
+    pqxx::work* currentWork() const {
+        std::lock_guard<std::mutex> lock(transactionMutex);
+        auto it = transactions.find(std::this_thread::get_id());
+        return it == transactions.end() ? nullptr : it->second.work.get();
+    }
+
+    // Сколько раз выполнять оператор, откатанный из-за взаимоблокировки
+    static constexpr int MAX_ROLLBACK_ATTEMPTS = 3;
+
+    // runStandalone - оператор вне транзакции потока.
+    // Взаимоблокировка (40P01) и конфликт сериализации откатывают его
+    // целиком, поэтому он выполняется заново на свежей транзакции.
+    // Внутри транзакции потока повтор невозможен: она уже прервана.
+    template<typename Transaction, typename Statement>
+    pqxx::result runStandalone(Statement& statement) {
+        for (int attempt = 1; ; ++attempt) {
+            try {
+                auto conn = acquire();
+                Transaction tx(*conn);
+                pqxx::result res = statement(tx);
+                tx.commit();
+                return res;
+            } catch (const pqxx::transaction_rollback& e) {
+                if (attempt >= MAX_ROLLBACK_ATTEMPTS) {
+                    throw;
+                }
+                LOG_WARNING("Оператор откатан сервером, повтор " << attempt << ": " << e.what());
+            }
+        }
+    }
+
+    // runQuery - чтение: в открытой транзакции потока или в nontransaction
+    template<typename Statement>
+    pqxx::result runQuery(Statement&& statement) {
+        if (pqxx::work* tx = currentWork()) {
+            return statement(*tx);
+        }
+        return runStandalone<pqxx::nontransaction>(statement);
+    }
+
+    // runCommand - изменение: в открытой транзакции потока
+    // (фиксируется в commitTransaction) или в отдельной транзакции
+    template<typename Statement>
+    pqxx::result runCommand(Statement&& statement) {
+        if (pqxx::work* tx = currentWork()) {
+            return statement(*tx);
+        }
+        return runStandalone<pqxx::work>(statement);
+    }
+
+public:
+    //КОНСТРУКТОР
+    explicit DatabaseConnection(const T& connectionString,
+                                const PoolOptions& poolOptions = PoolOptions())
+        : connectionString(connectionString), options(poolOptions) {
+        if (options.maxSize == 0) {
+            options.maxSize = 1;
+        }
+        options.initialSize = std::max<std::size_t>(1, std::min(options.initialSize, options.maxSize));
+
+        try {
+            // Заранее открываем initialSize соединений
+            for (std::size_t i = 0; i < options.initialSize; ++i) {
+                idle.push_back(openConnection());
+                ++openCount;
             }
+            LOG_INFO("Подключено к БД: " << idle.front()->conn.dbname()
+                     << " (соединений в пуле: " << openCount
+                     << ", максимум: " << options.maxSize << ")");
         } catch (const std::exception& e) {
             throw std::runtime_error("Ошибка подключения: " + std::string(e.what()));
         }
     }
 
+    // Запрещаем копирование
+    DatabaseConnection(const DatabaseConnection&) = delete;
+    DatabaseConnection& operator=(const DatabaseConnection&) = delete;
+
+    // acquire - взять соединение из пула
+    // Ждет не дольше waitTimeout, если все соединения заняты и пул достиг maxSize.
+    PooledConnection acquire() {
+        std::unique_lock<std::mutex> lock(poolMutex);
+        auto deadline = std::chrono::steady_clock::now() + options.waitTimeout;
+
+        while (true) {
+            if (closing) {
+                throw std::runtime_error("Пул соединений закрыт");
+            }
+
+            // 1. Есть свободное соединение
+            if (!idle.empty()) {
+                auto c = std::move(idle.back());
+                idle.pop_back();
+                lock.unlock();
+
+                if (options.validateOnCheckout && !isAlive(*c)) {
+                    // Переоткрываем разорванное соединение
+                    try {
+                        c = openConnection();
+                    } catch (...) {
+                        lock.lock();
+                        --openCount;
+                        lock.unlock();
+                        poolCondition.notify_one();
+                        throw;
+                    }
+                }
+                PooledConnection pooled(this, std::move(c));
+                prepareStatements(*pooled.conn);
+                return pooled;
+            }
+
+            // 2. Пул еще не заполнен - открываем новое соединение
+            if (openCount < options.maxSize) {
+                ++openCount;
+                lock.unlock();
+                std::unique_ptr<PoolEntry> c;
+                try {
+                    c = openConnection();
+                } catch (...) {
+                    lock.lock();
+                    --openCount;
+                    lock.unlock();
+                    poolCondition.notify_one();
+                    throw;
+                }
+                PooledConnection pooled(this, std::move(c));
+                prepareStatements(*pooled.conn);
+                return pooled;
+            }
+
+            // 3. Ждем, пока кто-нибудь вернет соединение
+            if (poolCondition.wait_until(lock, deadline) == std::cv_status::timeout &&
+                idle.empty() && openCount >= options.maxSize) {
+                throw std::runtime_error("Таймаут ожидания свободного соединения");
+            }
+        }
+    }
+
+    // healthCheck - проверка свободных соединений запросом SELECT 1
+    // Разорванные соединения переоткрываются. Возвращает число исправных.
+    std::size_t healthCheck() {
+        std::vector<std::unique_ptr<PoolEntry>> toCheck;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            toCheck.swap(idle);
+        }
+
+        std::size_t healthy = 0;
+        for (auto& c : toCheck) {
+            try {
+                pqxx::nontransaction ntx(c->conn);
+                ntx.exec("SELECT 1");
+                ++healthy;
+            } catch (const std::exception& e) {
+                LOG_WARNING("Соединение не отвечает: " << e.what());
+                try {
+                    c = openConnection();
+                    ++healthy;
+                } catch (const std::exception&) {
+                    c.reset();
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            for (auto& c : toCheck) {
+                if (c) {
+                    idle.push_back(std::move(c));
+                } else {
+                    --openCount;
+                }
+            }
+        }
+        poolCondition.notify_all();
+        return healthy;
+    }
+
     // executeQuery
+    // Если в текущем потоке открыта транзакция, запрос выполняется в ней.
     std::vector<std::vector<std::string>> executeQuery(const std::string& sql) {
         std::vector<std::vector<std::string>> results;
 
         try {
-            if (!conn->is_open()) {
-                throw std::runtime_error("Соединение с БД закрыто");
-            }
-
-            // Используем nontransaction для SELECT
-            pqxx::nontransaction ntx(*conn);
-            pqxx::result res = ntx.exec(sql);
+            pqxx::result res = runQuery([&sql](pqxx::transaction_base& tx) {
+                return tx.exec(sql);
+            });
 
             // Преобразуем результат в вектор
-            for (const auto& row : res) {
-                std::vector<std::string> rowData;
-                for (const auto& field : row) {
-                    rowData.push_back(field.c_str());
-                }
-                results.push_back(rowData);
-            }
+            results = toRows(res);
 
         } catch (const std::exception& e) {
-            std::cerr << "Ошибка запроса: " << e.what() << std::endl;
-            std::cerr << "SQL: " << sql << std::endl;
+            LOG_ERROR("Ошибка запроса: " << e.what() << " | SQL: " << sql);
         }
 
         return results;
     }
 
     //  executeNonQuery
+    // Вне транзакции каждая команда фиксируется сразу (отдельный COMMIT).
     bool executeNonQuery(const std::string& sql) {
         try {
-            if (!conn->is_open()) {
-                throw std::runtime_error("Соединение с БД закрыто");
+            runCommand([&sql](pqxx::transaction_base& tx) {
+                return tx.exec(sql);
+            });
+            return true;
+
+        } catch (const std::exception& e) {
+            LOG_ERROR("Ошибка выполнения: " << e.what());
+            return false;
+        }
+    }
+
+    // ПОДГОТОВЛЕННЫЕ ЗАПРОСЫ
+    // registerStatement - регистрирует запрос под именем.
+    // Запрос готовится (parse/plan) один раз на каждом соединении пула,
+    // при первой выдаче соединения после регистрации.
+    void registerStatement(const std::string& name, const std::string& sql) {
+        std::lock_guard<std::mutex> lock(statementMutex);
+        for (const auto& statement : statements) {
+            if (statement.first == name) {
+                throw std::invalid_argument("Запрос уже зарегистрирован: " + name);
             }
+        }
+        statements.emplace_back(name, sql);
+    }
 
-            pqxx::work w(*conn);
-            w.exec(sql);
-            w.commit();
+    // Зарегистрированные запросы (имя, SQL) в порядке регистрации
+    std::vector<std::pair<std::string, std::string>> getStatements() const {
+        std::lock_guard<std::mutex> lock(statementMutex);
+        return statements;
+    }
+
+    // executePrepared - выполнение подготовленного запроса с параметрами
+    template<typename... Args>
+    std::vector<std::vector<std::string>> executePrepared(const std::string& name,
+                                                          Args&&... args) {
+        std::vector<std::vector<std::string>> results;
+
+        try {
+            pqxx::result res = runQuery([&](pqxx::transaction_base& tx) {
+                return tx.exec_prepared(name, std::forward<Args>(args)...);
+            });
+            results = toRows(res);
+
+        } catch (const std::exception& e) {
+            LOG_ERROR("Ошибка запроса: " << e.what() << " | Подготовленный запрос: " << name);
+        }
+
+        return results;
+    }
+
+    // executePreparedNonQuery - изменение данных подготовленным запросом
+    template<typename... Args>
+    bool executePreparedNonQuery(const std::string& name, Args&&... args) {
+        try {
+            runCommand([&](pqxx::transaction_base& tx) {
+                return tx.exec_prepared(name, std::forward<Args>(args)...);
+            });
             return true;
 
         } catch (const std::exception& e) {
-            std::cerr << "Ошибка выполнения: " << e.what() << std::endl;
+            LOG_ERROR("Ошибка выполнения: " << e.what() << " | Подготовленный запрос: " << name);
             return false;
         }
     }
 
+    // ТИПИЗИРОВАННЫЕ ЗАПРОСЫ
+    // query<int, std::string_view, double>(sql) - строки декодируются
+    // сразу в нужные типы, без копирования полей в std::string и без stoi/stod.
+    template<typename... Ts>
+    TypedResult<Ts...> query(const std::string& sql) {
+        try {
+            return TypedResult<Ts...>(runQuery([&sql](pqxx::transaction_base& tx) {
+                return tx.exec(sql);
+            }));
+
+        } catch (const std::exception& e) {
+            LOG_ERROR("Ошибка запроса: " << e.what() << " | SQL: " << sql);
+            return TypedResult<Ts...>();
+        }
+    }
+
+    // queryPrepared<Ts...>(name, args...) - то же для подготовленного запроса
+    template<typename... Ts, typename... Args>
+    TypedResult<Ts...> queryPrepared(const std::string& name, Args&&... args) {
+        auto result = tryQueryPrepared<Ts...>(name, std::forward<Args>(args)...);
+        return result ? std::move(*result) : TypedResult<Ts...>();
+    }
+
+    // tryQueryPrepared - то же, но ошибка отличима от пустого результата:
+    // nullopt - запрос не выполнен (ошибка записана в журнал)
+    template<typename... Ts, typename... Args>
+    std::optional<TypedResult<Ts...>> tryQueryPrepared(const std::string& name, Args&&... args) {
+        try {
+            return TypedResult<Ts...>(runQuery([&](pqxx::transaction_base& tx) {
+                return tx.exec_prepared(name, std::forward<Args>(args)...);
+            }));
+
+        } catch (const std::exception& e) {
+            LOG_ERROR("Ошибка запроса: " << e.what() << " | Подготовленный запрос: " << name);
+            return std::nullopt;
+        }
+    }
+
+    // ПОТОКОВОЕ ЧТЕНИЕ
+    // streamQuery - построчная обработка результата через серверный курсор.
+    // Строки читаются порциями по chunkSize (FETCH), поэтому в памяти
+    // одновременно находится не больше одной порции, каким бы большим
+    // ни был результат. onRow вызывается для каждой pqxx::row.
+    // Возвращает число обработанных строк.
+    template<typename RowHandler, typename... Args>
+    std::size_t streamQuery(const std::string& sql, std::size_t chunkSize,
+                            RowHandler&& onRow, Args&&... args) {
+        if (chunkSize == 0) {
+            chunkSize = 1;
+        }
+
+        std::string cursor = "stream_cursor_" + std::to_string(++cursorCounter);
+        std::string fetch = "FETCH FORWARD " + std::to_string(chunkSize) + " FROM " + cursor;
+        std::size_t total = 0;
+
+        // Курсор живет только внутри транзакции
+        auto readAll = [&](pqxx::transaction_base& tx) {
+            tx.exec_params("DECLARE " + cursor + " NO SCROLL CURSOR FOR " + sql,
+                           std::forward<Args>(args)...);
+            while (true) {
+                pqxx::result chunk = tx.exec(fetch);
+                for (const auto& row : chunk) {
+                    onRow(row);
+                }
+                total += chunk.size();
+                if (chunk.size() < chunkSize) {
+                    break;
+                }
+            }
+            tx.exec("CLOSE " + cursor);
+        };
+
+        if (pqxx::work* tx = currentWork()) {
+            readAll(*tx);
+        } else {
+            auto conn = acquire();
+            pqxx::work w(*conn);
+            readAll(w);
+            w.commit();
+        }
+        return total;
+    }
+
+    // streamRows - то же, но строка передается как вектор строк.
+    // Буфер строки переиспользуется, поэтому память не растет.
+    template<typename... Args>
+    std::size_t streamRows(const std::string& sql, std::size_t chunkSize,
+                           const std::function<void(const std::vector<std::string>&)>& onRow,
+                           Args&&... args) {
+        std::vector<std::string> rowData;
+
+        try {
+            return streamQuery(sql, chunkSize, [&](const pqxx::row& row) {
+                rowData.resize(row.size());
+                std::size_t i = 0;
+                for (const auto& field : row) {
+                    rowData[i++].assign(field.c_str(), field.size());
+                }
+                onRow(rowData);
+            }, std::forward<Args>(args)...);
+
+        } catch (const std::exception& e) {
+            LOG_ERROR("Ошибка запроса: " << e.what() << " | SQL: " << sql);
+            return 0;
+        }
+    }
+
     // ТРАНЗАКЦИИ
-    // beginTransaction
+    // beginTransaction - закрепляет за текущим потоком соединение из пула.
+    // До commit/rollback все execute* этого потока выполняются в этой транзакции.
     void beginTransaction() {
-        if (!currentTransaction) {
-            currentTransaction = std::make_unique<pqxx::work>(*conn);
-            std::cout << "Транзакция начата" << std::endl;
+        auto threadId = std::this_thread::get_id();
+        {
+            std::lock_guard<std::mutex> lock(transactionMutex);
+            if (transactions.count(threadId)) {
+                return;
+            }
         }
+
+        ActiveTransaction tx;
+        tx.connection = acquire();
+        tx.work = std::make_unique<pqxx::work>(*tx.connection);
+
+        {
+            std::lock_guard<std::mutex> lock(transactionMutex);
+            transactions.emplace(threadId, std::move(tx));
+        }
+        LOG_DEBUG("Транзакция начата");
     }
 
     // commitTransaction
     bool commitTransaction() {
-        if (currentTransaction) {
+        auto tx = takeTransaction();
+        if (tx) {
             try {
-                currentTransaction->commit();
-                currentTransaction.reset();
-                std::cout << "Транзакция завершена" << std::endl;
+                tx->work->commit();
+                LOG_DEBUG("Транзакция завершена");
                 return true;
             } catch (const std::exception& e) {
-                std::cerr << "Ошибка коммита: " << e.what() << std::endl;
+                LOG_ERROR("Ошибка коммита: " << e.what());
                 return false;
             }
         }
@@ -109,14 +772,14 @@ public:
 
     // rollbackTransaction
     bool rollbackTransaction() {
-        if (currentTransaction) {
+        auto tx = takeTransaction();
+        if (tx) {
             try {
-                currentTransaction->abort();
-                currentTransaction.reset();
-                std::cout << "↩Транзакция откатана" << std::endl;
+                tx->work->abort();
+                LOG_DEBUG("Транзакция откатана");
                 return true;
             } catch (const std::exception& e) {
-                std::cerr << "Ошибка отката: " << e.what() << std::endl;
+                LOG_ERROR("Ошибка отката: " << e.what());
                 return false;
             }
         }
@@ -135,30 +798,75 @@ public:
 
     // getTransactionStatus
     std::string getTransactionStatus() const {
-        if (currentTransaction) {
+        if (inTransaction()) {
             return "Транзакция активна";
         }
         return "Нет активной транзакции";
     }
 
+    // Открыта ли транзакция в текущем потоке
+    bool inTransaction() const {
+        return currentWork() != nullptr;
+    }
+
     //  ДЕСТРУКТОР
     ~DatabaseConnection() {
-        // Автоматический откат при разрушении объекта
-        if (currentTransaction) {
-            rollbackTransaction();
+        // Автоматический откат незавершенных транзакций
+        std::map<std::thread::id, ActiveTransaction> pending;
+        {
+            std::lock_guard<std::mutex> lock(transactionMutex);
+            pending.swap(transactions);
         }
+        for (auto& entry : pending) {
+            try {
+                entry.second.work->abort();
+            } catch (const std::exception& e) {
+                LOG_ERROR("Ошибка отката: " << e.what());
+            }
+        }
+        pending.clear();
 
-        // Закрытие соединения
-        if (conn && conn->is_open()) {
-            conn->close();
-            std::cout << "Соединение закрыто" << std::endl;
+        // Закрытие соединений
+        std::vector<std::unique_ptr<PoolEntry>> toClose;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            closing = true;
+            toClose.swap(idle);
+        }
+        poolCondition.notify_all();
+
+        for (auto& c : toClose) {
+            if (c && c->conn.is_open()) {
+                c->conn.close();
+            }
         }
+        if (!toClose.empty()) {
+            LOG_INFO("Соединения закрыты");
+        }
+    }
+
+    // Отдельное соединение вне пула для долгих сессий (LISTEN).
+    // Не учитывается в maxSize, закрывается владельцем.
+    std::unique_ptr<pqxx::connection> openDedicatedConnection() const {
+        return std::make_unique<pqxx::connection>(connectionString);
     }
 
     // Дополнительный метод для проверки подключения
     bool isConnected() const {
-        return conn && conn->is_open();
+        std::lock_guard<std::mutex> lock(poolMutex);
+        return openCount > 0 && !closing;
+    }
+
+    // Статистика пула
+    std::size_t getPoolSize() const {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        return openCount;
+    }
+
+    std::size_t getIdleCount() const {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        return idle.size();
     }
 };
 
-#endif 
+#endif
@@ -0,0 +1,115 @@
+// include/Logger.h
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>               // Для lock-free очереди
+#include <chrono>               // Для времени сообщения
+#include <condition_variable>   // Для пробуждения потока записи
+#include <cstdio>               // Для FILE*
+#include <memory>               // Для умных указателей
+#include <mutex>                // Для ожидания потока записи
+#include <sstream>              // Для форматирования в макросах
+#include <string>               // Для строк
+#include <string_view>          // Для текста сообщения
+#include <thread>               // Для фонового потока
+
+// УРОВНИ ЛОГИРОВАНИЯ
+enum class LogLevel : int {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+    Off = 4
+};
+
+// АСИНХРОННЫЙ ЛОГГЕР (одиночка)
+// Потоки только кладут сообщение в кольцевой буфер (без блокировок),
+// форматирование времени и запись в файл делает фоновый поток.
+// Если буфер переполнен, сообщение отбрасывается и учитывается в счетчике,
+// вызывающий поток никогда не ждет вывода.
+class Logger {
+public:
+    static constexpr std::size_t CAPACITY = 4096;       // Слотов в буфере (степень двойки)
+    static constexpr std::size_t MESSAGE_SIZE = 240;    // Максимальная длина сообщения
+
+    static Logger& instance();
+
+    // Быстрая проверка уровня: одна атомарная загрузка
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    void setLevel(LogLevel level) {
+        minLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    // Куда писать (по умолчанию stderr, чтобы не смешиваться с меню в stdout)
+    void setOutput(std::FILE* file);
+
+    // Поставить сообщение в очередь (не блокирует)
+    void write(LogLevel level, std::string_view message);
+
+    // Дождаться, пока фоновый поток запишет все сообщения
+    void flush();
+
+    std::size_t getDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    // Запрещаем копирование
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    ~Logger();
+
+private:
+    Logger();
+
+    // Слот кольцевого буфера
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        LogLevel level = LogLevel::Info;
+        std::chrono::system_clock::time_point time;
+        std::size_t length = 0;
+        char text[MESSAGE_SIZE];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+
+    // Позиции производителей и потребителя в разных кэш-линиях
+    alignas(64) std::atomic<std::size_t> enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> dequeuePos{0};
+
+    std::atomic<int> minLevel{static_cast<int>(LogLevel::Info)};
+    std::atomic<std::size_t> dropped{0};
+    std::atomic<std::FILE*> output;
+
+    std::atomic<bool> running{true};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable drainedCondition;
+    std::thread writer;
+
+    void writerLoop();
+    bool drain(std::string& buffer);
+    bool hasPending() const;
+};
+
+// МАКРОСЫ ЛОГИРОВАНИЯ
+// Выражение форматируется только если уровень включен:
+// при выключенном уровне стоимость - одна проверка.
+#define LOG_AT(level, expr)                                              \
+    do {                                                                 \
+        if (Logger::instance().isEnabled(level)) {                       \
+            std::ostringstream logStream_;                               \
+            logStream_ << expr;                                          \
+            Logger::instance().write(level, logStream_.str());           \
+        }                                                                \
+    } while (false)
+
+#define LOG_DEBUG(expr)   LOG_AT(LogLevel::Debug, expr)
+#define LOG_INFO(expr)    LOG_AT(LogLevel::Info, expr)
+#define LOG_WARNING(expr) LOG_AT(LogLevel::Warning, expr)
+#define LOG_ERROR(expr)   LOG_AT(LogLevel::Error, expr)
+
+#endif // LOGGER_H
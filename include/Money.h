@@ -0,0 +1,135 @@
+// include/Money.h
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cstdint>       // Для int64_t
+#include <optional>      // Для результата разбора
+#include <ostream>       // Для вывода в поток
+#include <string>        // Для строк
+#include <string_view>   // Для разбора без копирования
+
+// ДЕНЕЖНАЯ СУММА С ФИКСИРОВАННОЙ ТОЧКОЙ
+// Хранится целым числом копеек, поэтому сложение и умножение на
+// количество точные (в отличие от double). Соответствует NUMERIC(10,2)
+// в БД: разбирается из текстового вида NUMERIC и обратно без double.
+class Money {
+private:
+    std::int64_t cents;
+
+    constexpr explicit Money(std::int64_t value) : cents(value) {}
+
+public:
+    // Максимальная длина текстового вида: знак, 19 цифр, точка
+    static constexpr std::size_t MAX_TEXT = 21;
+
+    constexpr Money() : cents(0) {}
+
+    static constexpr Money fromCents(std::int64_t value) { return Money(value); }
+    static constexpr Money fromUnits(std::int64_t units, std::int64_t fraction = 0) {
+        return Money(units * 100 + fraction);
+    }
+
+    // Разбор "123", "123.4", "-123.45" (десятичный разделитель - точка или запятая).
+    // Лишние знаки после копеек округляются по третьему знаку.
+    static constexpr std::optional<Money> parse(std::string_view text) {
+        std::size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+            negative = text[i] == '-';
+            ++i;
+        }
+
+        std::int64_t units = 0;
+        std::size_t digits = 0;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++digits) {
+            if (digits >= 16) {
+                return std::nullopt;   // Не помещается в int64 копеек
+            }
+            units = units * 10 + (text[i] - '0');
+        }
+
+        std::int64_t fraction = 0;
+        std::size_t fractionDigits = 0;
+        bool roundUp = false;
+        if (i < text.size() && (text[i] == '.' || text[i] == ',')) {
+            ++i;
+            for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++fractionDigits) {
+                if (fractionDigits < 2) {
+                    fraction = fraction * 10 + (text[i] - '0');
+                } else if (fractionDigits == 2) {
+                    roundUp = text[i] >= '5';
+                }
+            }
+        }
+
+        if (i != text.size() || digits + fractionDigits == 0) {
+            return std::nullopt;
+        }
+        if (fractionDigits == 1) {
+            fraction *= 10;
+        }
+
+        std::int64_t value = units * 100 + fraction + (roundUp ? 1 : 0);
+        return Money(negative ? -value : value);
+    }
+
+    constexpr std::int64_t getCents() const { return cents; }
+
+    // Текстовый вид "-123.45" в buffer (не меньше MAX_TEXT), возвращает длину
+    constexpr std::size_t format(char* buffer) const {
+        // Модуль считается в беззнаковом типе, чтобы не переполнить INT64_MIN
+        std::uint64_t value = cents < 0 ? 0 - static_cast<std::uint64_t>(cents)
+                                        : static_cast<std::uint64_t>(cents);
+        char digits[MAX_TEXT] = {};
+        std::size_t count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0 || count < 3);   // Минимум "0.00"
+
+        std::size_t length = 0;
+        if (cents < 0) {
+            buffer[length++] = '-';
+        }
+        while (count > 2) {
+            buffer[length++] = digits[--count];
+        }
+        buffer[length++] = '.';
+        buffer[length++] = digits[1];
+        buffer[length++] = digits[0];
+        return length;
+    }
+
+    std::string toString() const {
+        char buffer[MAX_TEXT];
+        return std::string(buffer, format(buffer));
+    }
+
+    // АРИФМЕТИКА
+    constexpr Money operator+(Money other) const { return Money(cents + other.cents); }
+    constexpr Money operator-(Money other) const { return Money(cents - other.cents); }
+    constexpr Money operator-() const { return Money(-cents); }
+    constexpr Money operator*(std::int64_t quantity) const { return Money(cents * quantity); }
+
+    constexpr Money& operator+=(Money other) { cents += other.cents; return *this; }
+    constexpr Money& operator-=(Money other) { cents -= other.cents; return *this; }
+
+    // СРАВНЕНИЕ
+    constexpr bool operator==(Money other) const { return cents == other.cents; }
+    constexpr bool operator!=(Money other) const { return cents != other.cents; }
+    constexpr bool operator<(Money other) const { return cents < other.cents; }
+    constexpr bool operator>(Money other) const { return cents > other.cents; }
+    constexpr bool operator<=(Money other) const { return cents <= other.cents; }
+    constexpr bool operator>=(Money other) const { return cents >= other.cents; }
+};
+
+constexpr Money operator*(std::int64_t quantity, Money price) {
+    return price * quantity;
+}
+
+inline std::ostream& operator<<(std::ostream& out, Money value) {
+    char buffer[Money::MAX_TEXT];
+    return out.write(buffer, static_cast<std::streamsize>(value.format(buffer)));
+}
+
+#endif // MONEY_H
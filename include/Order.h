@@ -8,22 +8,32 @@
 #include <algorithm>    // Для STL алгоритмов
 #include <numeric>      // Для std::accumulate
 #include <functional>   // Для лямбда-функций
+#include <memory_resource>  // Для std::pmr
+#include <string_view>  // Для имени товара
+#include "Money.h"      // Для денежных сумм
+#include "OrderStatus.h"  // Для статуса заказа
 
 // Предварительное объявление
 class PaymentStrategy;
 
 //  КЛАСС OrderItem (КОМПОЗИЦИЯ с Order)
+// Хранится в Order по значению. Поддерживает std::pmr: внутри
+// std::pmr::vector имя товара размещается в памяти того же ресурса.
 class OrderItem {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
 private:
     int itemId;
     int productId;
-    std::string productName;
+    std::pmr::string productName;
     int quantity;
-    double price;
+    Money price;
 
 public:
-    OrderItem(int id, int prodId, const std::string& name, int qty, double pr)
-        : itemId(id), productId(prodId), productName(name), quantity(qty), price(pr) {}
+    OrderItem(int id, int prodId, std::string_view name, int qty, Money pr,
+              const allocator_type& alloc = {})
+        : itemId(id), productId(prodId), productName(name, alloc), quantity(qty), price(pr) {}
 
     // Запрещаем копирование (композиция)
     OrderItem(const OrderItem&) = delete;
@@ -33,17 +43,23 @@ public:
     OrderItem(OrderItem&&) = default;
     OrderItem& operator=(OrderItem&&) = default;
 
+    // Перемещение в память другого ресурса (при росте pmr::vector)
+    OrderItem(OrderItem&& other, const allocator_type& alloc)
+        : itemId(other.itemId), productId(other.productId),
+          productName(std::move(other.productName), alloc),
+          quantity(other.quantity), price(other.price) {}
+
     // Методы
-    double getTotal() const {
-        return quantity * price;
+    Money getTotal() const {
+        return price * quantity;
     }
 
     // Геттеры
     int getItemId() const { return itemId; }
     int getProductId() const { return productId; }
-    std::string getProductName() const { return productName; }
+    std::string_view getProductName() const { return productName; }
     int getQuantity() const { return quantity; }
-    double getPrice() const { return price; }
+    Money getPrice() const { return price; }
 };
 
 // АБСТРАКТНЫЙ КЛАСС PaymentStrategy
@@ -52,7 +68,7 @@ public:
     virtual ~PaymentStrategy() = default;
 
     //  ВИРТУАЛЬНАЯ ФУНКЦИЯ
-    virtual bool pay(double amount) = 0;
+    virtual bool pay(Money amount) = 0;
     virtual std::string getName() const = 0;
 };
 
@@ -60,12 +76,12 @@ public:
 class Payment {
 private:
     std::unique_ptr<PaymentStrategy> strategy;  // ⭐ unique_ptr - владение
-    double amount;
+    Money amount;
     bool isCompleted;
     std::string transactionId;
 
 public:
-    Payment(double amt, std::unique_ptr<PaymentStrategy> strat);
+    Payment(Money amt, std::unique_ptr<PaymentStrategy> strat);
 
     // Запрещаем копирование
     Payment(const Payment&) = delete;
@@ -76,7 +92,7 @@ public:
 
     // Геттеры
     bool getStatus() const { return isCompleted; }
-    double getAmount() const { return amount; }
+    Money getAmount() const { return amount; }
     std::string getTransactionId() const { return transactionId; }
 
 private:
@@ -85,22 +101,29 @@ private:
 };
 
 //  КЛАСС Order (основной)
+// Элементы хранятся по значению в std::pmr::vector. По умолчанию память
+// берется из кучи; с арендой (см. OrderHistory) заказ и его элементы
+// размещаются в ней и освобождаются вместе с ней.
 class Order {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
 private:
     int orderId;
     int userId;
-    std::string status;  // pending, completed, canceled, returned
-    double totalPrice;
+    OrderStatus status;  // Один байт, переходы - ORDER_TRANSITIONS
+    Money totalPrice;
 
-    //КОМПОЗИЦИЯ: Order ВЛАДЕЕТ OrderItem через unique_ptr
-    std::vector<std::unique_ptr<OrderItem>> items;
+    //КОМПОЗИЦИЯ: Order ВЛАДЕЕТ OrderItem (по значению)
+    std::pmr::vector<OrderItem> items;
 
     //КОМПОЗИЦИЯ: Order ВЛАДЕЕТ Payment через unique_ptr
     std::unique_ptr<Payment> payment;
 
 public:
     // Конструктор
-    Order(int id, int uid, const std::string& stat, double total);
+    Order(int id, int uid, OrderStatus stat, Money total,
+          const allocator_type& alloc = {});
 
     // Запрещаем копирование
     Order(const Order&) = delete;
@@ -110,8 +133,15 @@ public:
     Order(Order&&) = default;
     Order& operator=(Order&&) = default;
 
+    // Перемещение в память другого ресурса (при росте pmr::vector)
+    Order(Order&& other, const allocator_type& alloc);
+
+    allocator_type get_allocator() const { return items.get_allocator(); }
+
     // МЕТОДЫ ДЛЯ РАБОТЫ С ЭЛЕМЕНТАМИ ЗАКАЗА
-    void addItem(std::unique_ptr<OrderItem> item);
+    void reserveItems(std::size_t count) { items.reserve(count); }
+    OrderItem& addItem(int itemId, int productId, std::string_view productName,
+                       int quantity, Money price);
     bool removeItem(int productId);
 
     //  МЕТОДЫ ДЛЯ ОПЛАТЫ
@@ -123,25 +153,32 @@ public:
     // 1. Фильтрация заказов по статусу (лямбда + std::copy_if)
     static std::vector<std::shared_ptr<Order>> filterOrdersByStatus(
         const std::vector<std::shared_ptr<Order>>& orders,
-        const std::string& targetStatus);
+        OrderStatus targetStatus);
 
     // 2. Подсчет общей суммы (лямбда + std::accumulate)
-    double calculateTotal() const;
+    Money calculateTotal() const;
 
     // 3. Подсчет количества заказов в статусе
     static int countOrdersByStatus(
         const std::vector<std::shared_ptr<Order>>& orders,
-        const std::string& targetStatus);
+        OrderStatus targetStatus);
 
     // ГЕТТЕРЫ и СЕТТЕРЫ
     int getOrderId() const { return orderId; }
     int getUserId() const { return userId; }
-    std::string getStatus() const { return status; }
-    double getTotalPrice() const { return totalPrice; }
-    const std::vector<std::unique_ptr<OrderItem>>& getItems() const { return items; }
-
-    void setStatus(const std::string& newStatus) { status = newStatus; }
-    void setTotalPrice(double price) { totalPrice = price; }
+    OrderStatus getStatus() const { return status; }
+    Money getTotalPrice() const { return totalPrice; }
+    const std::pmr::vector<OrderItem>& getItems() const { return items; }
+
+    // Смена статуса по таблице переходов; false - переход недопустим
+    bool setStatus(OrderStatus newStatus) {
+        if (!canTransition(status, newStatus)) {
+            return false;
+        }
+        status = newStatus;
+        return true;
+    }
+    void setTotalPrice(Money price) { totalPrice = price; }
 };
 
 #endif // ORDER_H
\ No newline at end of file
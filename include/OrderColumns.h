@@ -0,0 +1,59 @@
+// include/OrderColumns.h
+#ifndef ORDERCOLUMNS_H
+#define ORDERCOLUMNS_H
+
+#include <array>         // Для счетчиков по статусам
+#include <cstddef>       // Для size_t
+#include <cstdint>       // Для целых фиксированной ширины
+#include <string>        // Для строк
+#include <vector>        // Для колонок
+#include "Money.h"       // Для сумм
+#include "OrderStatus.h" // Для статусов
+
+template<typename T> class DatabaseConnection;
+
+// КОЛОНОЧНЫЙ СНИМОК ЗАКАЗОВ (структура массивов)
+// Каждое поле заказа хранится в своем непрерывном массиве, поэтому
+// фильтр, подсчет и сумма проходят по памяти подряд, без указателей и
+// строк. Циклы написаны без ветвлений, чтобы компилятор их векторизовал.
+// Снимок только для чтения: после загрузки не меняется.
+class OrderColumns {
+private:
+    std::vector<std::int32_t> orderIds;
+    std::vector<std::int32_t> userIds;
+    std::vector<std::uint8_t> statuses;      // Значения OrderStatus
+    std::vector<std::int64_t> totalCents;    // Суммы в копейках
+    std::vector<std::int64_t> orderDates;    // Секунды Unix
+
+public:
+    // Загрузка всех заказов серверным курсором порциями по chunkSize
+    static OrderColumns load(DatabaseConnection<std::string>& db, std::size_t chunkSize = 10000);
+
+    void reserve(std::size_t count);
+    void append(int orderId, int userId, OrderStatus status, Money total, std::int64_t orderDate);
+
+    std::size_t size() const { return orderIds.size(); }
+    bool empty() const { return orderIds.empty(); }
+
+    // АНАЛИТИКА
+    std::size_t countByStatus(OrderStatus status) const;
+    Money sumByStatus(OrderStatus status) const;
+
+    // Число заказов по всем статусам за один проход
+    std::array<std::size_t, ORDER_STATUS_COUNT> countAllStatuses() const;
+
+    // Сумма заказов с датой в [from, to)
+    Money sumInPeriod(std::int64_t from, std::int64_t to) const;
+
+    // Номера строк с нужным статусом
+    std::vector<std::size_t> filterByStatus(OrderStatus status) const;
+
+    // ДОСТУП К СТРОКЕ
+    int getOrderId(std::size_t row) const { return orderIds[row]; }
+    int getUserId(std::size_t row) const { return userIds[row]; }
+    OrderStatus getStatus(std::size_t row) const { return static_cast<OrderStatus>(statuses[row]); }
+    Money getTotal(std::size_t row) const { return Money::fromCents(totalCents[row]); }
+    std::int64_t getOrderDate(std::size_t row) const { return orderDates[row]; }
+};
+
+#endif // ORDERCOLUMNS_H
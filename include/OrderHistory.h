@@ -0,0 +1,42 @@
+// include/OrderHistory.h
+#ifndef ORDERHISTORY_H
+#define ORDERHISTORY_H
+
+#include <cstddef>          // Для size_t
+#include <memory_resource>  // Для арены
+#include <string>           // Для строк
+#include "Order.h"          // Для заказов
+
+template<typename T> class DatabaseConnection;
+
+// ИСТОРИЯ ЗАКАЗОВ ПОКУПАТЕЛЯ (в арене)
+// Заказы, их элементы и имена товаров размещаются в одной монотонной
+// арене: загрузка - несколько крупных выделений вместо одного на каждый
+// объект, уничтожение - одно освобождение арены.
+// Объект рассчитан на один запрос: повторная load() не возвращает
+// память прежней истории, она освобождается только вместе с объектом.
+class OrderHistory {
+private:
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<Order> orders;
+
+public:
+    explicit OrderHistory(std::size_t initialBytes = 64 * 1024);
+
+    // Запрещаем копирование и перемещение (заказы ссылаются на арену)
+    OrderHistory(const OrderHistory&) = delete;
+    OrderHistory& operator=(const OrderHistory&) = delete;
+
+    // Все заказы пользователя с элементами, новые первыми.
+    // При ошибке история остается пустой
+    bool load(DatabaseConnection<std::string>& db, int userId);
+
+    const std::pmr::vector<Order>& getOrders() const { return orders; }
+    std::size_t size() const { return orders.size(); }
+    bool empty() const { return orders.empty(); }
+
+    // Заказ по ID (nullptr - нет в истории)
+    const Order* find(int orderId) const;
+};
+
+#endif // ORDERHISTORY_H
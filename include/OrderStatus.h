@@ -0,0 +1,82 @@
+// include/OrderStatus.h
+#ifndef ORDERSTATUS_H
+#define ORDERSTATUS_H
+
+#include <array>         // Для таблиц статусов
+#include <cstdint>       // Для uint8_t
+#include <optional>      // Для результата разбора
+#include <string_view>   // Для имен статусов
+
+// СТАТУС ЗАКАЗА (один байт)
+// Значения совпадают с индексами в ORDER_STATUS_NAMES
+enum class OrderStatus : std::uint8_t {
+    Pending = 0,
+    Processing = 1,
+    Completed = 2,
+    Canceled = 3,
+    Returned = 4
+};
+
+constexpr std::size_t ORDER_STATUS_COUNT = 5;
+
+// Имена статусов в БД (orders.status)
+constexpr std::array<std::string_view, ORDER_STATUS_COUNT> ORDER_STATUS_NAMES = {
+    "pending", "processing", "completed", "canceled", "returned"
+};
+
+constexpr std::string_view toString(OrderStatus status) {
+    return ORDER_STATUS_NAMES[static_cast<std::size_t>(status)];
+}
+
+constexpr std::optional<OrderStatus> parseOrderStatus(std::string_view name) {
+    for (std::size_t i = 0; i < ORDER_STATUS_COUNT; ++i) {
+        if (ORDER_STATUS_NAMES[i] == name) {
+            return static_cast<OrderStatus>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+// ТАБЛИЦА ПЕРЕХОДОВ
+// Для каждого статуса - битовая маска статусов, в которые можно перейти.
+// Та же таблица проверяется на сервере (isValidStatusTransition).
+constexpr std::uint8_t statusBit(OrderStatus status) {
+    return static_cast<std::uint8_t>(1u << static_cast<unsigned>(status));
+}
+
+constexpr std::array<std::uint8_t, ORDER_STATUS_COUNT> ORDER_TRANSITIONS = {
+    // pending -> processing, completed, canceled
+    static_cast<std::uint8_t>(statusBit(OrderStatus::Processing) |
+                              statusBit(OrderStatus::Completed) |
+                              statusBit(OrderStatus::Canceled)),
+    // processing -> completed, canceled
+    static_cast<std::uint8_t>(statusBit(OrderStatus::Completed) |
+                              statusBit(OrderStatus::Canceled)),
+    // completed -> returned, canceled
+    static_cast<std::uint8_t>(statusBit(OrderStatus::Returned) |
+                              statusBit(OrderStatus::Canceled)),
+    // canceled, returned - конечные
+    0,
+    0
+};
+
+constexpr bool canTransition(OrderStatus from, OrderStatus to) {
+    return (ORDER_TRANSITIONS[static_cast<std::size_t>(from)] & statusBit(to)) != 0;
+}
+
+// Есть ли хоть один статус, из которого можно перейти в target
+constexpr bool isReachable(OrderStatus target) {
+    for (std::size_t i = 0; i < ORDER_STATUS_COUNT; ++i) {
+        if (canTransition(static_cast<OrderStatus>(i), target)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static_assert(sizeof(OrderStatus) == 1, "Статус заказа должен занимать один байт");
+static_assert(canTransition(OrderStatus::Pending, OrderStatus::Completed), "pending -> completed");
+static_assert(!canTransition(OrderStatus::Canceled, OrderStatus::Pending), "canceled - конечный статус");
+static_assert(!isReachable(OrderStatus::Pending), "В pending вернуться нельзя");
+
+#endif // ORDERSTATUS_H
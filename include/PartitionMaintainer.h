@@ -0,0 +1,46 @@
+// include/PartitionMaintainer.h
+#ifndef PARTITIONMAINTAINER_H
+#define PARTITIONMAINTAINER_H
+
+#include <chrono>              // Для интервала обслуживания
+#include <condition_variable>  // Для ожидания между запусками
+#include <memory>              // Для умных указателей
+#include <mutex>               // Для ожидания остановки
+#include <string>              // Для строк
+#include <thread>              // Для фонового потока
+
+template<typename T> class DatabaseConnection;
+
+// ПЛАНОВОЕ ОБСЛУЖИВАНИЕ СЕКЦИЙ ЖУРНАЛОВ
+// Поток вызывает процедуру maintainPartitions (sql/partitioning.sql) при
+// запуске и затем раз в interval: заранее создает секции следующих месяцев
+// и удаляет секции старше срока хранения. Запускается одним долгоживущим
+// процессом (OnlineStoreServer), а не каждым клиентом.
+// Если partitioning.sql не применен, поток пишет предупреждение и
+// проверяет снова на следующем интервале.
+class PartitionMaintainer {
+public:
+    explicit PartitionMaintainer(std::shared_ptr<DatabaseConnection<std::string>> db,
+                                 std::chrono::minutes interval = std::chrono::hours(6));
+
+    // Запрещаем копирование
+    PartitionMaintainer(const PartitionMaintainer&) = delete;
+    PartitionMaintainer& operator=(const PartitionMaintainer&) = delete;
+
+    // Останавливает поток (дожидается текущего обслуживания)
+    ~PartitionMaintainer();
+
+private:
+    std::shared_ptr<DatabaseConnection<std::string>> db;
+    std::chrono::minutes interval;
+
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+    bool stopping = false;
+    std::thread worker;
+
+    void workLoop();
+    void runOnce();
+};
+
+#endif // PARTITIONMAINTAINER_H
@@ -2,7 +2,7 @@
 #ifndef PAYMENT_H
 #define PAYMENT_H
 
-#include <iostream>
+#include "Order.h"   // Для PaymentStrategy
 #include <memory>
 #include <string>
 #include <ctime>
@@ -21,7 +21,7 @@ public:
                      const std::string& expiry)
         : cardNumber(card), cardHolder(holder), expiryDate(expiry) {}
 
-    bool pay(double amount) override;
+    bool pay(Money amount) override;
     std::string getName() const override;
 };
 
@@ -35,7 +35,7 @@ public:
     WalletPayment(const std::string& id, const std::string& type)
         : walletId(id), walletType(type) {}
 
-    bool pay(double amount) override;
+    bool pay(Money amount) override;
     std::string getName() const override;
 };
 
@@ -49,7 +49,7 @@ public:
     SBPPayment(const std::string& phone, const std::string& bank)
         : phoneNumber(phone), bankName(bank) {}
 
-    bool pay(double amount) override;
+    bool pay(Money amount) override;
     std::string getName() const override;
 };
 
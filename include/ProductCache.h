@@ -0,0 +1,76 @@
+// include/ProductCache.h
+#ifndef PRODUCTCACHE_H
+#define PRODUCTCACHE_H
+
+#include <atomic>          // Для флагов потока подписки
+#include <cstdint>         // Для счетчика поколений
+#include <memory>          // Для умных указателей
+#include <optional>        // Для отсутствующего товара
+#include <shared_mutex>    // Для параллельного чтения
+#include <string>          // Для строк
+#include <thread>          // Для потока подписки
+#include <unordered_map>   // Для товаров по ID
+#include <unordered_set>   // Для устаревших ID
+#include <vector>          // Для списков
+#include "Money.h"         // Для цены
+
+template<typename T> class DatabaseConnection;
+
+// ТОВАР В КЭШЕ
+struct CachedProduct {
+    int productId = 0;
+    std::string name;
+    Money price;
+    int stockQuantity = 0;
+};
+
+// КЭШ КАТАЛОГА ТОВАРОВ
+// Чтение идет из памяти под разделяемой блокировкой. Триггер на products
+// шлет pg_notify('product_changes', product_id), поток подписки помечает
+// товар устаревшим, и следующее чтение перечитывает только его.
+// Пока подписка не установлена (или оборвалась), кэш не используется
+// и все чтения идут в БД, поэтому устаревшая цена не возвращается.
+class ProductCache {
+public:
+    static constexpr const char* CHANNEL = "product_changes";
+
+    explicit ProductCache(std::shared_ptr<DatabaseConnection<std::string>> db);
+
+    // Запрещаем копирование
+    ProductCache(const ProductCache&) = delete;
+    ProductCache& operator=(const ProductCache&) = delete;
+
+    // Останавливает поток подписки
+    ~ProductCache();
+
+    // Товар по ID (при промахе читается из БД и кэшируется)
+    std::optional<CachedProduct> get(int productId);
+
+    // Товары в наличии, по возрастанию ID
+    std::vector<CachedProduct> getAvailable();
+
+    // Инвалидация (вызывается потоком подписки)
+    void invalidate(int productId);
+    void invalidateAll();
+
+    bool isListening() const { return listening.load(std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<DatabaseConnection<std::string>> db;
+
+    mutable std::shared_mutex cacheMutex;
+    std::unordered_map<int, CachedProduct> products;
+    std::unordered_set<int> staleIds;    // Изменены после загрузки каталога
+    bool catalogLoaded = false;          // В products весь каталог
+    std::uint64_t generation = 0;        // Растет при каждой инвалидации
+
+    std::atomic<bool> listening{false};
+    std::atomic<bool> stopping{false};
+    std::thread listener;
+
+    void listenLoop();
+    bool refreshCatalog();
+    std::vector<CachedProduct> loadAvailable();
+};
+
+#endif // PRODUCTCACHE_H
@@ -0,0 +1,46 @@
+// include/RepriceWorker.h
+#ifndef REPRICEWORKER_H
+#define REPRICEWORKER_H
+
+#include <atomic>     // Для флагов потока
+#include <chrono>     // Для интервала опроса
+#include <memory>     // Для умных указателей
+#include <string>     // Для строк
+#include <thread>     // Для фонового потока
+
+template<typename T> class DatabaseConnection;
+
+// ИСПОЛНИТЕЛЬ ЗАДАНИЙ ПЕРЕСЧЕТА ЦЕН
+// Триггер trg_update_order_prices ставит крупные пересчеты в reprice_jobs
+// и шлет pg_notify('reprice_jobs'). Поток держит отдельное соединение
+// с LISTEN и по уведомлению (или раз в pollInterval, если уведомление
+// потерялось) вызывает процедуру processRepriceJobs.
+class RepriceWorker {
+public:
+    static constexpr const char* CHANNEL = "reprice_jobs";
+
+    explicit RepriceWorker(std::shared_ptr<DatabaseConnection<std::string>> db,
+                           std::chrono::seconds pollInterval = std::chrono::seconds(60));
+
+    // Запрещаем копирование
+    RepriceWorker(const RepriceWorker&) = delete;
+    RepriceWorker& operator=(const RepriceWorker&) = delete;
+
+    // Останавливает поток (дожидается текущей порции заданий)
+    ~RepriceWorker();
+
+    // Запросить выполнение заданий (вызывается по уведомлению)
+    void wake() { wakeRequested.store(true, std::memory_order_release); }
+
+private:
+    std::shared_ptr<DatabaseConnection<std::string>> db;
+    std::chrono::seconds pollInterval;
+
+    std::atomic<bool> wakeRequested{true};   // При запуске - выполнить накопившиеся
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+
+    void workLoop();
+};
+
+#endif // REPRICEWORKER_H
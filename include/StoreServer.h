@@ -0,0 +1,129 @@
+// include/StoreServer.h
+#ifndef STORESERVER_H
+#define STORESERVER_H
+
+#include <atomic>              // Для флага остановки
+#include <condition_variable>  // Для ожидания рабочих потоков
+#include <cstddef>             // Для size_t
+#include <cstdint>             // Для номера порта
+#include <deque>               // Для очереди сессий
+#include <memory>              // Для умных указателей
+#include <mutex>               // Для защиты очереди
+#include <string>              // Для строк
+#include <string_view>         // Для строки запроса
+#include <thread>              // Для потоков
+#include <unordered_map>       // Для таблицы сессий
+#include <vector>              // Для списка потоков
+
+template<typename T> class DatabaseConnection;
+class AuditQueue;
+class ProductCache;
+
+// Состояние одного клиента (определено в StoreServer.cpp)
+struct ServerSession;
+
+// ПАРАМЕТРЫ СЕРВЕРА
+struct ServerOptions {
+    std::string host = "127.0.0.1";        // По умолчанию только локальные клиенты
+    std::uint16_t port = 5555;
+    std::size_t workers = 4;               // Потоки, выполняющие запросы
+    std::size_t maxSessions = 10000;       // Сверх этого новые соединения закрываются
+    std::size_t maxLineLength = 64 * 1024; // Максимальная длина строки запроса
+};
+
+// СЕРВЕР ЗАПРОСОВ (строковый протокол поверх TCP)
+// Один поток ввода-вывода обслуживает все сокеты через poll(), запросы
+// выполняют рабочие потоки. Запросы одной сессии выполняются по очереди
+// (ответы приходят в порядке запросов), разных сессий - параллельно.
+// Рабочие потоки берут соединения из общего пула DatabaseConnection,
+// поэтому размер пула должен быть не меньше числа рабочих потоков плюс
+// фоновые пользователи того же пула (см. src/server_main.cpp).
+//
+// Протокол: запрос - одна строка, слова через пробел. Ответ:
+//   OK <число строк> [<курсор>]   затем строки данных, поля через TAB
+//   ERR <текст ошибки>
+// В полях TAB, перевод строки и обратная косая черта экранируются
+// (\t, \n, \\), как в COPY. Курсор есть, если у списка есть следующая
+// страница; он передается последним аргументом следующего запроса.
+//
+// Команды (роль указана в скобках):
+//   PING, QUIT, LOGIN <user_id> <пароль>, LOGOUT
+//   PRODUCTS, STATUS <order>, CANCEL <order>
+//   ORDER <товар>:<кол-во> ...                  (customer)
+//   MY_ORDERS [<размер> [<курсор>]]             (customer)
+//   ADD <order> <товар> <кол-во>, REMOVE <позиция>,
+//   PAY <order> <способ>, RETURN <order>        (customer)
+//   PENDING [<размер> [<курсор>]], APPROVE <order>,
+//   STOCK <товар> <кол-во>, APPROVED            (manager)
+//   ORDERS [<размер> [<курсор>]],
+//   AUDIT [<дни> [<размер> [<курсор>]]], AUDIT_BY_USER <user_id>,
+//   SET_STATUS <order> <статус>, REPRICE_JOBS,
+//   STATUS_HISTORY <order>                      (admin)
+//
+// Вход: user_id и пароль (остаток строки), пароль сверяется в БД с
+// bcrypt-хешем users.password_hash; пользователь без пароля по сети не
+// входит. После 3 неудачных попыток сессия закрывается.
+// Трафик не шифруется: по умолчанию сервер слушает только 127.0.0.1,
+// удаленным клиентам нужен TLS-туннель (stunnel, ssh -L) до этого адреса.
+class StoreServer {
+public:
+    StoreServer(std::shared_ptr<DatabaseConnection<std::string>> db,
+                std::shared_ptr<AuditQueue> auditQueue,
+                std::shared_ptr<ProductCache> productCache,
+                ServerOptions options = ServerOptions());
+
+    // Запрещаем копирование
+    StoreServer(const StoreServer&) = delete;
+    StoreServer& operator=(const StoreServer&) = delete;
+
+    ~StoreServer();
+
+    // Открывает сокет и запускает потоки (false - ошибка, см. журнал)
+    bool start();
+
+    // Останавливает потоки и закрывает все соединения.
+    // Невыполненные запросы клиентов отбрасываются
+    void stop();
+
+    // Число открытых сессий
+    std::size_t sessionCount() const;
+
+private:
+    std::shared_ptr<DatabaseConnection<std::string>> db;
+    std::shared_ptr<AuditQueue> auditQueue;
+    std::shared_ptr<ProductCache> productCache;
+    ServerOptions options;
+
+    int listenFd = -1;
+    int wakePipe[2] = {-1, -1};   // Будит поток ввода-вывода из рабочих потоков
+
+    // Сессии по дескриптору сокета (только поток ввода-вывода)
+    std::unordered_map<int, std::shared_ptr<ServerSession>> sessions;
+    std::atomic<std::size_t> openSessions{0};
+
+    // Сессии с запросами, ожидающие рабочего потока
+    std::deque<std::shared_ptr<ServerSession>> readyQueue;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+
+    std::atomic<bool> stopping{false};
+    std::thread ioThread;
+    std::vector<std::thread> workers;
+
+    // ПОТОК ВВОДА-ВЫВОДА
+    void ioLoop();
+    void acceptClients();
+    void readFromClient(const std::shared_ptr<ServerSession>& session);
+    void closeFinishedSessions();
+    void wakeIo();
+
+    // РАБОЧИЕ ПОТОКИ
+    void workerLoop();
+    void schedule(std::shared_ptr<ServerSession> session);
+
+    // Выполнение одной строки запроса, результат - текст ответа
+    std::string execute(ServerSession& session, std::string_view line);
+    std::string login(ServerSession& session, int userId, const std::string& password);
+};
+
+#endif // STORESERVER_H
@@ -0,0 +1,28 @@
+// include/TablePrinter.h
+#ifndef TABLEPRINTER_H
+#define TABLEPRINTER_H
+
+#include <iostream>   // Для потока вывода по умолчанию
+#include <string>     // Для строк
+#include <vector>     // Для строк таблицы
+
+// ВЫВОД ТАБЛИЦ В КОНСОЛЬ
+// Поток вывода передается параметром (по умолчанию std::cout),
+// чтобы таблицу можно было вывести в файл или замерить без консоли.
+
+// Вывод заголовка таблицы
+void printTableHeader(const std::vector<std::string>& headers,
+                      const std::vector<size_t>& columnWidths,
+                      std::ostream& out = std::cout);
+
+// Вывод одной строки таблицы
+void printTableRow(const std::vector<std::string>& row,
+                   const std::vector<size_t>& columnWidths,
+                   std::ostream& out = std::cout);
+
+// Вывод таблицы с подбором ширины колонок
+void printTable(const std::vector<std::vector<std::string>>& data,
+                const std::vector<std::string>& headers,
+                std::ostream& out = std::cout);
+
+#endif // TABLEPRINTER_H
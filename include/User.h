@@ -6,10 +6,50 @@
 #include <vector>      // Для контейнеров
 #include <string>      // Для строк
 #include <functional>  // Для лямбда-функций
+#include <optional>    // Для результатов пакетной обработки
+#include "Money.h"     // Для цен товаров
+#include "OrderStatus.h"  // Для статуса заказа
+#include "AuditAction.h"  // Для кода действия аудита
 
 // Предварительные объявления (чтобы избежать циклических зависимостей)
 class Order;
+class OrderColumns;
+class OrderHistory;
 template<typename T> class DatabaseConnection;
+class AuditQueue;
+class ProductCache;
+
+// ПОЗИЦИЯ СТРАНИЦЫ (keyset-курсор)
+// Ключ последней строки предыдущей страницы. Следующая страница читается
+// по индексу сразу после этого ключа ((дата, id) < (lastTime, lastId) для
+// списков "новые первыми"), поэтому глубокая страница стоит столько же,
+// сколько первая.
+struct PageCursor {
+    std::string lastTime;   // Время строки в текстовом виде БД (timestamp)
+    int lastId = 0;
+};
+
+// Больший размер страницы приводится к этому значению, меньше 1 - к 1
+constexpr std::size_t MAX_PAGE_SIZE = 1000;
+
+// СТРАНИЦА СПИСКА
+struct Page {
+    std::vector<std::vector<std::string>> rows;
+    std::optional<PageCursor> next;   // Нет - страница последняя
+};
+
+// РЕЗУЛЬТАТ ОПЕРАЦИИ ПОЛЬЗОВАТЕЛЯ
+// Успех или причина отказа. Причина - текст для пользователя: консоль
+// выводит его в меню, сервер - в строке ERR. Журнал - только диагностика.
+struct ActionResult {
+    bool ok = false;
+    std::string message;   // Причина отказа (при успехе - итог или пусто)
+
+    static ActionResult success(std::string note = std::string()) { return {true, std::move(note)}; }
+    static ActionResult failure(std::string reason) { return {false, std::move(reason)}; }
+
+    explicit operator bool() const { return ok; }
+};
 
 // БАЗОВЫЙ КЛАСС User (АБСТРАКТНЫЙ)
 class User {
@@ -27,6 +67,19 @@ protected:
     // Подключение к БД
     std::shared_ptr<DatabaseConnection<std::string>> db;
 
+    // Очередь аудита (если не задана, аудит пишется синхронно)
+    std::shared_ptr<AuditQueue> auditQueue;
+
+    // Кэш каталога (если не задан, каталог читается из БД)
+    std::shared_ptr<ProductCache> productCache;
+
+    // Запись события аудита от имени пользователя
+    // payload - JSON-объект с данными операции (необязательно)
+    bool writeAudit(const std::string& entityType, std::optional<int> entityId,
+                    const std::string& operation, AuditAction action,
+                    const std::string& details,
+                    std::optional<std::string> payload = std::nullopt);
+
 public:
     // Конструктор
     User(int id, const std::string& name, const std::string& email,
@@ -37,9 +90,9 @@ public:
     virtual ~User() = default;
 
     //  ВИРТУАЛЬНЫЕ ФУНКЦИИ
-    virtual void createOrder(const std::vector<std::pair<int, int>>& products) = 0;
+    virtual ActionResult createOrder(const std::vector<std::pair<int, int>>& products) = 0;
     virtual std::string viewOrderStatus(int orderId) = 0;
-    virtual bool cancelOrder(int orderId) = 0;
+    virtual ActionResult cancelOrder(int orderId) = 0;
 
     // ОБЩИЕ МЕТОДЫ (не виртуальные)
     int getUserId() const { return userId; }
@@ -51,6 +104,20 @@ public:
     void addOrder(std::shared_ptr<Order> order);
     std::vector<std::shared_ptr<Order>> getOrders() const;
 
+    // Подключение асинхронной очереди аудита
+    void setAuditQueue(std::shared_ptr<AuditQueue> queue);
+
+    // Подключение кэша каталога товаров
+    void setProductCache(std::shared_ptr<ProductCache> cache);
+
+    // Общие запросы для всех ролей
+    std::vector<std::vector<std::string>> getOrderStatusHistory(int orderId);
+    std::vector<std::vector<std::string>> getAvailableProducts();
+
+    // Регистрация подготовленных запросов, которые используют классы пользователей.
+    // Вызывается один раз после создания подключения к БД.
+    static void registerStatements(DatabaseConnection<std::string>& db);
+
     // ЛЯМБДА-ФУНКЦИЯ для проверки прав
     static std::function<bool(const User&, const std::string&)> getAccessChecker() {
         // Лямбда-функция проверяет, есть ли у пользователя нужная роль
@@ -67,28 +134,49 @@ public:
           std::shared_ptr<DatabaseConnection<std::string>> dbConn);
 
     // ПЕРЕОПРЕДЕЛЕНИЕ виртуальных функций
-    void createOrder(const std::vector<std::pair<int, int>>& products) override;
+    ActionResult createOrder(const std::vector<std::pair<int, int>>& products) override;
     std::string viewOrderStatus(int orderId) override;
-    bool cancelOrder(int orderId) override;
+    ActionResult cancelOrder(int orderId) override;
 
     // СПЕЦИФИЧНЫЕ МЕТОДЫ Admin
-    bool addProduct(const std::string& name, double price, int stockQuantity);
+    bool addProduct(const std::string& name, Money price, int stockQuantity);
     bool updateProduct(int productId, const std::string& name,
-                      double price, int stockQuantity);
+                      Money price, int stockQuantity);
     bool deleteProduct(int productId);
 
-    // Просмотр всех заказов
-    std::vector<std::vector<std::string>> viewAllOrders();
+    // Просмотр всех заказов постранично (новые первыми)
+    Page viewAllOrders(std::size_t pageSize = 50,
+                       const std::optional<PageCursor>& after = std::nullopt);
+
+    // Потоковый просмотр всех заказов: строки передаются в onRow порциями
+    // по chunkSize, вся таблица в память не загружается
+    std::size_t streamAllOrders(
+        const std::function<void(const std::vector<std::string>&)>& onRow,
+        std::size_t chunkSize = 500);
+
+    // Колоночный снимок всех заказов для сводок (см. OrderColumns)
+    OrderColumns loadOrderSnapshot();
 
     // Обновление статуса заказа через хранимую процедуру
-    bool updateOrderStatus(int orderId, const std::string& newStatus);
+    ActionResult updateOrderStatus(int orderId, OrderStatus newStatus);
 
     // Работа с аудитом
-    std::vector<std::vector<std::string>> getAuditLog();
+    // Записи аудита за days дней постранично (новые первыми)
+    Page getAuditLog(int days = 30, std::size_t pageSize = 100,
+                     const std::optional<PageCursor>& after = std::nullopt);
     std::vector<std::vector<std::string>> getAuditLogByUser(int userId);
 
-    // Генерация CSV отчета
+    // Последние задания пересчета цен заказов и их прогресс
+    std::vector<std::vector<std::string>> getRepriceJobs();
+
+    // Генерация CSV отчета (по заказам за последние 30 дней)
     bool generateCSVReport(const std::string& filename);
+
+    // Отчет за период, даты в формате YYYY-MM-DD (конец включительно).
+    // Пустое значение - граница по умолчанию
+    bool generateCSVReport(const std::string& filename,
+                           const std::optional<std::string>& startDate,
+                           const std::optional<std::string>& endDate);
 };
 
 // КЛАСС-НАСЛЕДНИК Manager
@@ -98,21 +186,29 @@ public:
             std::shared_ptr<DatabaseConnection<std::string>> dbConn);
 
     //  ПЕРЕОПРЕДЕЛЕНИЕ виртуальных функций
-    void createOrder(const std::vector<std::pair<int, int>>& products) override;
+    ActionResult createOrder(const std::vector<std::pair<int, int>>& products) override;
     std::string viewOrderStatus(int orderId) override;
-    bool cancelOrder(int orderId) override;
+    ActionResult cancelOrder(int orderId) override;
 
     //  СПЕЦИФИЧНЫЕ МЕТОДЫ Manager
-    bool approveOrder(int orderId);
-    bool updateStock(int productId, int newQuantity);
+    ActionResult approveOrder(int orderId);
+    ActionResult updateStock(int productId, int newQuantity);
 
-    // Просмотр ожидающих заказов
-    std::vector<std::vector<std::string>> getPendingOrders();
+    // Просмотр ожидающих заказов постранично (старые первыми)
+    Page getPendingOrders(std::size_t pageSize = 50,
+                          const std::optional<PageCursor>& after = std::nullopt);
 
     // История утвержденных заказов
     std::vector<std::vector<std::string>> getApprovedOrdersHistory();
 };
 
+// Результат создания одного заказа из пакета
+struct BatchOrderResult {
+    int cartIndex;                // Номер корзины во входном пакете
+    std::optional<int> orderId;   // ID созданного заказа (нет - ошибка)
+    std::string error;            // Текст ошибки
+};
+
 // КЛАСС-НАСЛЕДНИК Customer
 class Customer : public User {
 private:
@@ -123,20 +219,31 @@ public:
              int loyalty, std::shared_ptr<DatabaseConnection<std::string>> dbConn);
 
     // ПЕРЕОПРЕДЕЛЕНИЕ виртуальных функций
-    void createOrder(const std::vector<std::pair<int, int>>& products) override;
+    ActionResult createOrder(const std::vector<std::pair<int, int>>& products) override;
     std::string viewOrderStatus(int orderId) override;
-    bool cancelOrder(int orderId) override;
+    ActionResult cancelOrder(int orderId) override;
 
     //  СПЕЦИФИЧНЫЕ МЕТОДЫ Customer
-    bool addToOrder(int orderId, int productId, int quantity);
-    bool removeFromOrder(int orderItemId);
-    bool makePayment(int orderId, const std::string& paymentMethod);
+    // Пакетное создание заказов (импорт): корзины отправляются на сервер
+    // порциями по chunkSize, по одному вызову на порцию. Товары порции
+    // заблокированы до конца вызова, поэтому порции небольшие
+    std::vector<BatchOrderResult> createOrders(
+        const std::vector<std::vector<std::pair<int, int>>>& carts,
+        std::size_t chunkSize = 100);
+
+    ActionResult addToOrder(int orderId, int productId, int quantity);
+    ActionResult removeFromOrder(int orderItemId);
+    ActionResult makePayment(int orderId, const std::string& paymentMethod);
 
     // Возврат товара
-    bool returnOrder(int orderId);
+    ActionResult returnOrder(int orderId);
 
     // Просмотр истории своих заказов
-    std::vector<std::vector<std::string>> getMyOrderHistory();
+    Page getMyOrderHistory(std::size_t pageSize = 20,
+                           const std::optional<PageCursor>& after = std::nullopt);
+
+    // Полная история заказов с элементами (объекты размещены в арене)
+    std::unique_ptr<OrderHistory> loadOrderHistory();
 
     // Геттер для уровня лояльности
     int getLoyaltyLevel() const { return loyaltyLevel; }
@@ -0,0 +1,181 @@
+#!/usr/bin/env bash
+# Проверка сетевого сервера на локальной базе
+# Запускает OnlineStoreServer на базе из STORE_DSN и проверяет ответы
+# OK/ERR: вход, создание заказа, страницы по курсору, запрет доступа,
+# закрытие сессии после неудачных входов и параллельные сессии.
+#
+#   STORE_DSN="host=localhost dbname=online_store_test" \
+#       scripts/server_check.sh build/OnlineStoreServer [порт]
+#
+# Нужны psql, схема, database_setup.sql и хотя бы один товар с остатком.
+# Скрипт создает тестовых пользователей и заказы - используйте отдельную
+# базу, как для замеров с БД.
+set -u
+
+SERVER=${1:-./OnlineStoreServer}
+PORT=${2:-55123}
+PASSWORD="server-check-secret"
+FAILURES=0
+
+if [ -z "${STORE_DSN:-}" ]; then
+    echo "Задайте строку подключения в STORE_DSN" >&2
+    exit 2
+fi
+if [ ! -x "$SERVER" ]; then
+    echo "Не найден исполняемый файл сервера: $SERVER" >&2
+    exit 2
+fi
+
+sql() {
+    psql "$STORE_DSN" -v ON_ERROR_STOP=1 -qAtX -c "$1"
+}
+
+# ТЕСТОВЫЕ ДАННЫЕ
+# Пользователи каждой роли с паролем; суффикс делает email уникальным
+SUFFIX="$(date +%s)_$$"
+create_user() {
+    sql "INSERT INTO users (name, email, role, password_hash)
+         VALUES ('server_check_$1', 'server_check_$1_${SUFFIX}@example.com', '$1',
+                 crypt('$PASSWORD', gen_salt('bf')))
+         RETURNING user_id" | head -n 1
+}
+
+CUSTOMER_ID=$(create_user customer) || exit 2
+MANAGER_ID=$(create_user manager) || exit 2
+ADMIN_ID=$(create_user admin) || exit 2
+PRODUCT_ID=$(sql "SELECT product_id FROM products WHERE stock_quantity >= 10
+                  ORDER BY product_id LIMIT 1")
+if [ -z "$PRODUCT_ID" ]; then
+    echo "В базе нет товара с остатком" >&2
+    exit 2
+fi
+
+# ЗАПУСК СЕРВЕРА
+STORE_DSN="$STORE_DSN" "$SERVER" "$PORT" 4 > server_check.log 2>&1 &
+SERVER_PID=$!
+trap 'kill "$SERVER_PID" 2>/dev/null; wait "$SERVER_PID" 2>/dev/null' EXIT
+
+# Сессия: строки запросов, затем QUIT; печатает все ответы сервера
+session() {
+    exec 3<>"/dev/tcp/127.0.0.1/$PORT" || return 1
+    printf '%s\n' "$@" QUIT >&3
+    timeout 10 cat <&3
+    exec 3<&-
+}
+
+for _ in $(seq 1 50); do
+    if session PING 2>/dev/null | grep -q '^OK 0'; then
+        break
+    fi
+    sleep 0.2
+done
+
+# Ответ номер $2 (с 1) из вывода сессии $1: заголовок и строки данных
+reply() {
+    printf '%s\n' "$1" | awk -v want="$2" '
+        skip > 0 { skip--; if (n == want) print; next }
+        { n++; if (n == want) print; if ($1 == "OK") skip = $2 }'
+}
+
+# Проверка заголовка ответа $2 сессии $1 по шаблону $3
+expect() {
+    local header
+    header=$(reply "$1" "$2" | head -n 1)
+    if printf '%s\n' "$header" | grep -Eq "$3"; then
+        echo "OK:   $4"
+    else
+        echo "FAIL: $4 (ожидалось /$3/, получено '$header')"
+        FAILURES=$((FAILURES + 1))
+    fi
+}
+
+# ВХОД И ДОСТУП
+out=$(session PING "MY_ORDERS" "LOGIN $CUSTOMER_ID wrong-password" "LOGIN $CUSTOMER_ID $PASSWORD")
+expect "$out" 1 '^OK 0$' "PING"
+expect "$out" 2 '^ERR ' "запрос без входа отклонен"
+expect "$out" 3 '^ERR ' "неверный пароль отклонен"
+expect "$out" 4 '^OK 1$' "вход покупателя"
+
+out=$(session "LOGIN $CUSTOMER_ID $PASSWORD" "PENDING" "STATUS_HISTORY 1" "ORDERS")
+expect "$out" 2 '^ERR ' "покупателю недоступен PENDING"
+expect "$out" 3 '^ERR ' "покупателю недоступен STATUS_HISTORY"
+expect "$out" 4 '^ERR ' "покупателю недоступен ORDERS"
+
+# ЗАКАЗЫ
+out=$(session "LOGIN $CUSTOMER_ID $PASSWORD" "ORDER $PRODUCT_ID:1" "ORDER $PRODUCT_ID:1" "ORDER 0:1")
+expect "$out" 2 '^OK 1$' "первый заказ создан"
+expect "$out" 3 '^OK 1$' "второй заказ создан"
+expect "$out" 4 '^ERR ' "заказ несуществующего товара отклонен"
+FIRST_ORDER=$(reply "$out" 2 | sed -n 2p)
+SECOND_ORDER=$(reply "$out" 3 | sed -n 2p)
+
+# СТРАНИЦЫ ПО КУРСОРУ
+out=$(session "LOGIN $CUSTOMER_ID $PASSWORD" "MY_ORDERS 1")
+expect "$out" 2 '^OK 1 [^ ]+,[0-9]+$' "первая страница с курсором"
+CURSOR=$(reply "$out" 2 | head -n 1 | awk '{ print $3 }')
+PAGE1_ORDER=$(reply "$out" 2 | sed -n 2p | cut -f 1)
+
+out=$(session "LOGIN $CUSTOMER_ID $PASSWORD" "MY_ORDERS 1 $CURSOR" "MY_ORDERS 5" "MY_ORDERS 1 bad-cursor")
+expect "$out" 2 '^OK 1$' "последняя страница без курсора"
+expect "$out" 3 '^OK 2$' "все заказы на одной странице"
+expect "$out" 4 '^ERR ' "некорректный курсор отклонен"
+PAGE2_ORDER=$(reply "$out" 2 | sed -n 2p | cut -f 1)
+if [ "$PAGE1_ORDER" = "$SECOND_ORDER" ] && [ "$PAGE2_ORDER" = "$FIRST_ORDER" ]; then
+    echo "OK:   страницы идут от новых заказов к старым без повторов"
+else
+    echo "FAIL: страницы: $PAGE1_ORDER, $PAGE2_ORDER (ожидались $SECOND_ORDER, $FIRST_ORDER)"
+    FAILURES=$((FAILURES + 1))
+fi
+
+# МЕНЕДЖЕР И АДМИНИСТРАТОР
+out=$(session "LOGIN $MANAGER_ID $PASSWORD" "APPROVE $FIRST_ORDER" "ORDERS")
+expect "$out" 1 '^OK 1$' "вход менеджера"
+expect "$out" 2 '^OK 0$' "заказ утвержден"
+expect "$out" 3 '^ERR ' "менеджеру недоступен ORDERS"
+
+out=$(session "LOGIN $ADMIN_ID $PASSWORD" "ORDERS 1" "STATUS_HISTORY $FIRST_ORDER")
+expect "$out" 1 '^OK 1$' "вход администратора"
+expect "$out" 2 '^OK 1 [^ ]+,[0-9]+$' "страница всех заказов с курсором"
+expect "$out" 3 '^OK [1-9][0-9]*$' "история статусов для администратора"
+
+out=$(session "LOGIN $CUSTOMER_ID $PASSWORD" "CANCEL $SECOND_ORDER")
+expect "$out" 2 '^OK 0$' "заказ отменен покупателем"
+
+# Три неудачных входа закрывают сессию: четвертый запрос не выполняется
+out=$(session "LOGIN $ADMIN_ID x" "LOGIN $ADMIN_ID y" "LOGIN $ADMIN_ID z" PING)
+expect "$out" 3 '^ERR ' "третий неудачный вход"
+if [ -z "$(reply "$out" 4)" ]; then
+    echo "OK:   сессия закрыта после трех неудачных входов"
+else
+    echo "FAIL: сессия продолжила работу после трех неудачных входов"
+    FAILURES=$((FAILURES + 1))
+fi
+
+# ПАРАЛЛЕЛЬНЫЕ СЕССИИ
+PARALLEL=50
+TMP_DIR=$(mktemp -d)
+for i in $(seq 1 "$PARALLEL"); do
+    session "LOGIN $CUSTOMER_ID $PASSWORD" "MY_ORDERS 5" PRODUCTS > "$TMP_DIR/$i" &
+done
+wait $(jobs -p | grep -v "^$SERVER_PID$")
+passed=0
+for i in $(seq 1 "$PARALLEL"); do
+    out=$(cat "$TMP_DIR/$i")
+    if reply "$out" 2 | head -n 1 | grep -q '^OK 2$' &&
+       reply "$out" 3 | head -n 1 | grep -q '^OK '; then
+        passed=$((passed + 1))
+    fi
+done
+rm -rf "$TMP_DIR"
+if [ "$passed" -eq "$PARALLEL" ]; then
+    echo "OK:   $PARALLEL параллельных сессий"
+else
+    echo "FAIL: параллельные сессии: успешно $passed из $PARALLEL"
+    FAILURES=$((FAILURES + 1))
+fi
+
+if [ "$FAILURES" -gt 0 ]; then
+    echo "Ошибок: $FAILURES (журнал сервера: server_check.log)"
+    exit 1
+fi
+echo "Все проверки пройдены"
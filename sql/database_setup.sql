@@ -1,5 +1,10 @@
 
--- Процедура createOrder с транзакцией
+-- Процедура createOrder (set-based)
+-- Число операторов не зависит от размера корзины:
+--   1. корзина разбирается из JSON один раз (позиции одного товара суммируются);
+--   2. строки товаров блокируются FOR UPDATE в порядке product_id,
+--      поэтому параллельные корзины не взаимоблокируются;
+--   3. одна проверка наличия, один INSERT в order_items, один UPDATE склада.
 CREATE OR REPLACE PROCEDURE createOrder(
     user_id_param INTEGER,
     product_items JSONB,
@@ -10,109 +15,262 @@ LANGUAGE plpgsql
 AS $$
 DECLARE
 order_total DECIMAL(10,2) := 0;
-    item RECORD;
-    product_record RECORD;
-    insufficient_stock BOOLEAN := FALSE;
-    stock_error_message TEXT := '';
+    item_product_ids INTEGER[];
+    item_quantities INTEGER[];
+    missing_product_id INTEGER;
+    stock_error_message TEXT;
 BEGIN
-    --НАЧАЛО ТРАНЗАКЦИИ 
+    -- Блок с обработчиком исключений: при ошибке все изменения
+    -- этой процедуры откатываются автоматически
 BEGIN
         -- Проверяем существование пользователя
         IF NOT EXISTS (SELECT 1 FROM users WHERE user_id = user_id_param) THEN
             RAISE EXCEPTION 'Пользователь с ID % не найден', user_id_param;
 END IF;
 
-        -- Проверяем все товары на наличие
-FOR item IN SELECT * FROM jsonb_array_elements(product_items) AS items
-    LOOP
-SELECT * INTO product_record
-FROM products
-WHERE product_id = (items->>'product_id')::INTEGER;
+        -- Разбираем корзину один раз
+SELECT array_agg(product_id ORDER BY product_id),
+       array_agg(quantity ORDER BY product_id)
+INTO item_product_ids, item_quantities
+FROM (
+         SELECT (e->>'product_id')::INTEGER AS product_id,
+                SUM((e->>'quantity')::INTEGER) AS quantity
+         FROM jsonb_array_elements(product_items) AS e
+         GROUP BY 1
+     ) cart;
 
-IF NOT FOUND THEN
-                RAISE EXCEPTION 'Товар с ID % не найден', (items->>'product_id')::INTEGER;
+IF item_product_ids IS NULL THEN
+            RAISE EXCEPTION 'Пустой заказ';
 END IF;
 
-            -- Проверяем количество на складе
-            IF product_record.stock_quantity < (items->>'quantity')::INTEGER THEN
-                insufficient_stock := TRUE;
-                stock_error_message := format('Недостаточно товара: %s. В наличии: %s, Заказано: %s',
-                    product_record.name,
-                    product_record.stock_quantity,
-                    (items->>'quantity')::INTEGER);
-                EXIT;
+        IF EXISTS (SELECT 1 FROM unnest(item_quantities) AS q WHERE q <= 0) THEN
+            RAISE EXCEPTION 'Количество должно быть больше 0';
 END IF;
-END LOOP;
 
-        
-        IF insufficient_stock THEN
+        -- Блокируем товары в порядке product_id (единый порядок блокировок)
+PERFORM 1
+FROM products
+WHERE product_id = ANY(item_product_ids)
+ORDER BY product_id
+    FOR UPDATE;
+
+-- Проверяем, что все товары существуют
+SELECT c.product_id INTO missing_product_id
+FROM unnest(item_product_ids) AS c(product_id)
+         LEFT JOIN products p ON p.product_id = c.product_id
+WHERE p.product_id IS NULL
+    LIMIT 1;
+
+IF missing_product_id IS NOT NULL THEN
+            RAISE EXCEPTION 'Товар с ID % не найден', missing_product_id;
+END IF;
+
+        -- Проверяем наличие на складе одним запросом
+SELECT format('Недостаточно товара: %s. В наличии: %s, Заказано: %s',
+              p.name, p.stock_quantity, c.quantity)
+INTO stock_error_message
+FROM unnest(item_product_ids, item_quantities) AS c(product_id, quantity)
+         JOIN products p ON p.product_id = c.product_id
+WHERE p.stock_quantity < c.quantity
+ORDER BY c.product_id
+    LIMIT 1;
+
+IF stock_error_message IS NOT NULL THEN
             RAISE EXCEPTION '%', stock_error_message;
 END IF;
 
-        -- Создаем заказ
+        -- Считаем сумму заказа
+SELECT SUM(p.price * c.quantity)
+INTO order_total
+FROM unnest(item_product_ids, item_quantities) AS c(product_id, quantity)
+         JOIN products p ON p.product_id = c.product_id;
+
+-- Создаем заказ сразу с итоговой суммой
 INSERT INTO orders (user_id, status, total_price)
-VALUES (user_id_param, 'pending', 0)
+VALUES (user_id_param, 'pending', order_total)
     RETURNING order_id INTO new_order_id;
 
--- Добавляем элементы заказа и считаем сумму
-FOR item IN SELECT * FROM jsonb_array_elements(product_items) AS items
-    LOOP
-SELECT * INTO product_record
-FROM products
-WHERE product_id = (items->>'product_id')::INTEGER;
-
--- Вставляем элемент заказа
+-- Добавляем все элементы заказа одним INSERT
 INSERT INTO order_items (order_id, product_id, quantity, price)
-VALUES (
-           new_order_id,
-           (items->>'product_id')::INTEGER,
-           (items->>'quantity')::INTEGER,
-           product_record.price
-       );
-
--- Обновляем общую сумму
-order_total := order_total + (product_record.price * (items->>'quantity')::INTEGER);
-
-            -- Обновляем количество на складе
-UPDATE products
-SET stock_quantity = stock_quantity - (items->>'quantity')::INTEGER
-WHERE product_id = (items->>'product_id')::INTEGER;
-END LOOP;
+SELECT new_order_id, c.product_id, c.quantity, p.price
+FROM unnest(item_product_ids, item_quantities) AS c(product_id, quantity)
+         JOIN products p ON p.product_id = c.product_id
+ORDER BY c.product_id;
 
-        -- Обновляем общую сумму заказа
-UPDATE orders
-SET total_price = order_total
-WHERE order_id = new_order_id;
+-- Списываем товары со склада одним UPDATE
+UPDATE products p
+SET stock_quantity = p.stock_quantity - c.quantity
+    FROM unnest(item_product_ids, item_quantities) AS c(product_id, quantity)
+WHERE p.product_id = c.product_id;
 
 -- Записываем в историю статусов
 INSERT INTO order_status_history (order_id, old_status, new_status, changed_by)
 VALUES (new_order_id, NULL, 'pending', user_id_param);
 
 -- Записываем в аудит
-INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
+INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action, payload)
 VALUES ('order', new_order_id, 'insert', user_id_param,
-        format('Создан заказ на сумму: %s', order_total));
+        format('Создан заказ на сумму: %s', order_total),
+        'order_created', jsonb_build_object('total_price', order_total));
 
 result_message := 'Заказ успешно создан';
 
-        --ЗАВЕРШЕНИЕ ТРАНЗАКЦИИ
-COMMIT;
-
-EXCEPTION WHEN OTHERS THEN
-        -- ОТКАТ ТРАНЗАКЦИИ ПРИ ОШИБКЕ 
-        ROLLBACK;
+EXCEPTION
+        -- Взаимоблокировка и таймауты - не ошибка корзины: пробрасываем,
+        -- чтобы вызывающая сторона повторила вызов, а не сочла заказ отклоненным
+        WHEN deadlock_detected OR serialization_failure OR lock_not_available
+             OR query_canceled THEN
+            RAISE;
+        WHEN OTHERS THEN
+        -- Изменения блока уже откатаны, фиксируем только ошибку
         result_message := 'Ошибка создания заказа: ' || SQLERRM;
         new_order_id := NULL;
 
         -- Записываем ошибку в аудит
-INSERT INTO audit_log (entity_type, operation, performed_by, details)
+INSERT INTO audit_log (entity_type, operation, performed_by, details, action, payload)
 VALUES ('order', 'error', user_id_param,
-        'Ошибка создания заказа: ' || SQLERRM);
+        'Ошибка создания заказа: ' || SQLERRM,
+        'order_error', jsonb_build_object('sqlstate', SQLSTATE));
 END;
 END;
 $$;
 
+-- Функция createOrders: пакетное создание заказов (импорт B2B)
+-- carts - JSON-массив корзин в формате createOrder.
+-- Каждая корзина создается в своем блоке исключений, поэтому ошибка
+-- одной корзины не отменяет остальные. Весь пакет - один вызов сервера.
+-- Товары всех корзин блокируются заранее одним запросом в порядке
+-- product_id: иначе два параллельных импорта брали бы блокировки в
+-- порядке корзин и взаимоблокировались. Блокировки держатся до конца
+-- вызова, поэтому порции должны быть небольшими (Customer::createOrders).
+-- Взаимоблокировка прерывает весь вызов, а не одну корзину.
+CREATE OR REPLACE FUNCTION createOrders(user_id_param INTEGER, carts JSONB)
+RETURNS TABLE(
+    cart_index INTEGER,
+    new_order_id INTEGER,
+    error_message TEXT
+)
+LANGUAGE plpgsql
+AS $$
+DECLARE
+cart JSONB;
+    created_order_id INTEGER;
+    message TEXT;
+BEGIN
+    -- Единый порядок блокировок для всей порции
+PERFORM 1
+FROM products
+WHERE product_id IN (
+    SELECT (e->>'product_id')::INTEGER
+    FROM jsonb_array_elements(carts) AS c(cart), jsonb_array_elements(c.cart) AS e
+)
+ORDER BY product_id
+    FOR UPDATE;
+
+FOR cart, cart_index IN
+SELECT c.value, (c.ordinality - 1)::INTEGER
+FROM jsonb_array_elements(carts) WITH ORDINALITY AS c(value, ordinality)
+    LOOP
+        CALL createOrder(user_id_param, cart, created_order_id, message);
+
+new_order_id := created_order_id;
+        error_message := CASE WHEN created_order_id IS NULL THEN message END;
+        RETURN NEXT;
+END LOOP;
+END;
+$$;
+
+-- Процедура cancelOrder: отмена заказа за один вызов
+-- Возвращает товары на склад одним UPDATE (без цикла по позициям),
+-- меняет статус и записывает аудит в одной транзакции
+CREATE OR REPLACE PROCEDURE cancelOrder(
+    order_id_param INTEGER,
+    user_id_param INTEGER,
+    OUT canceled BOOLEAN,
+    OUT result_message TEXT
+)
+LANGUAGE plpgsql
+AS $$
+DECLARE
+old_status_var VARCHAR;
+BEGIN
+    canceled := FALSE;
+
+    -- Блокируем заказ: параллельная отмена не вернет товары на склад дважды
+SELECT status INTO old_status_var
+FROM orders
+WHERE order_id = order_id_param
+    FOR UPDATE;
+
+IF NOT FOUND THEN
+        result_message := 'Заказ не найден';
+        RETURN;
+END IF;
+
+    IF old_status_var = 'canceled' THEN
+        result_message := 'Заказ уже отменен';
+        RETURN;
+END IF;
+
+    IF NOT isValidStatusTransition(old_status_var, 'canceled') THEN
+        result_message := format('Заказ в статусе %s нельзя отменить', old_status_var);
+        RETURN;
+END IF;
+
+    -- Блокируем товары заказа в порядке product_id, как createOrder:
+    -- UPDATE ... FROM берет блокировки в порядке соединения, и встречная
+    -- отмена или создание заказа с теми же товарами могли взаимоблокироваться
+PERFORM 1
+FROM products
+WHERE product_id IN (SELECT product_id FROM order_items WHERE order_id = order_id_param)
+ORDER BY product_id
+    FOR UPDATE;
+
+    -- Возвращаем товары на склад (позиции одного товара суммируются)
+UPDATE products p
+SET stock_quantity = p.stock_quantity + oi.quantity
+    FROM (
+        SELECT product_id, SUM(quantity) AS quantity
+        FROM order_items
+        WHERE order_id = order_id_param
+        GROUP BY product_id
+    ) oi
+WHERE p.product_id = oi.product_id;
+
+-- Обновляем статус заказа
+UPDATE orders
+SET status = 'canceled'
+WHERE order_id = order_id_param;
+
+-- Записываем в аудит
+INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action, payload)
+VALUES ('order', order_id_param, 'update', user_id_param,
+        'Заказ отменен администратором',
+        'order_canceled', jsonb_build_object('old_status', old_status_var, 'new_status', 'canceled'));
+
+canceled := TRUE;
+    result_message := 'Заказ отменен';
+END;
+$$;
+
+-- Функция isValidStatusTransition - таблица переходов статусов заказа
+-- Совпадает с ORDER_TRANSITIONS в include/OrderStatus.h
+CREATE OR REPLACE FUNCTION isValidStatusTransition(old_status VARCHAR, new_status VARCHAR)
+RETURNS BOOLEAN AS $$
+SELECT (old_status, new_status) IN (
+    ('pending', 'processing'),
+    ('pending', 'completed'),
+    ('pending', 'canceled'),
+    ('processing', 'completed'),
+    ('processing', 'canceled'),
+    ('completed', 'returned'),
+    ('completed', 'canceled')
+);
+$$ LANGUAGE sql IMMUTABLE;
+
 -- Процедура updateOrderStatus
+-- Недопустимый переход отклоняется исключением, поэтому вызывающая
+-- сторона получает ошибку, а не сообщение об успехе.
 CREATE OR REPLACE PROCEDURE updateOrderStatus(
     order_id_param INTEGER,
     new_status_param VARCHAR,
@@ -123,38 +281,35 @@ LANGUAGE plpgsql
 AS $$
 DECLARE
 old_status_var VARCHAR;
-    current_status_var VARCHAR;
-BEGIN
 BEGIN
-        -- Получаем текущий статус
-SELECT status INTO current_status_var
+    -- Получаем текущий статус и блокируем заказ до конца транзакции
+SELECT status INTO old_status_var
 FROM orders
-WHERE order_id = order_id_param;
+WHERE order_id = order_id_param
+    FOR UPDATE;
 
 IF NOT FOUND THEN
-            RAISE EXCEPTION 'Заказ не найден';
+        RAISE EXCEPTION 'Заказ % не найден', order_id_param;
 END IF;
 
-        -- Сохраняем старый статус
-        old_status_var := current_status_var;
+    IF NOT isValidStatusTransition(old_status_var, new_status_param) THEN
+        RAISE EXCEPTION 'Недопустимый переход статуса заказа %: % -> %',
+            order_id_param, old_status_var, new_status_param;
+END IF;
 
-        -- Обновляем статус
+    -- Обновляем статус
 UPDATE orders
 SET status = new_status_param
 WHERE order_id = order_id_param;
 
 -- Записываем в аудит
-INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
+INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action, payload)
 VALUES ('order', order_id_param, 'update', changed_by_param,
-        format('Статус изменен с %s на %s', old_status_var, new_status_param));
+        format('Статус изменен с %s на %s', old_status_var, new_status_param),
+        'order_status_changed',
+        jsonb_build_object('old_status', old_status_var, 'new_status', new_status_param));
 
 result_message := 'Статус успешно обновлен';
-COMMIT;
-
-EXCEPTION WHEN OTHERS THEN
-        ROLLBACK;
-        result_message := 'Ошибка обновления статуса: ' || SQLERRM;
-END;
 END;
 $$;
 
@@ -174,32 +329,31 @@ RETURN COALESCE(order_status, 'not_found');
 END;
 $$ LANGUAGE plpgsql;
 
--- 2. getUserOrderCount - количество заказов пользователя
+-- 2. getUserOrderCount - количество заказов пользователя (из user_order_stats)
 CREATE OR REPLACE FUNCTION getUserOrderCount(user_id_param INTEGER)
 RETURNS INTEGER AS $$
 DECLARE
 order_count INTEGER;
 BEGIN
-SELECT COUNT(*) INTO order_count
-FROM orders
+SELECT orders_count INTO order_count
+FROM user_order_stats
 WHERE user_id = user_id_param;
 
 RETURN COALESCE(order_count, 0);
 END;
 $$ LANGUAGE plpgsql;
 
--- 3. getTotalSpentByUser - общая сумма покупок
+-- 3. getTotalSpentByUser - общая сумма покупок (из user_order_stats)
 CREATE OR REPLACE FUNCTION getTotalSpentByUser(user_id_param INTEGER)
 RETURNS DECIMAL AS $$
 DECLARE
 total_spent DECIMAL;
 BEGIN
-SELECT COALESCE(SUM(total_price), 0) INTO total_spent
-FROM orders
-WHERE user_id = user_id_param
-  AND status IN ('completed', 'returned');
+SELECT us.total_spent INTO total_spent
+FROM user_order_stats us
+WHERE us.user_id = user_id_param;
 
-RETURN total_spent;
+RETURN COALESCE(total_spent, 0);
 END;
 $$ LANGUAGE plpgsql;
 
@@ -210,7 +364,8 @@ DECLARE
 order_record RECORD;
     days_passed INTEGER;
 BEGIN
-SELECT status, order_date INTO order_record
+-- Срок считается от завершения заказа (последней смены статуса)
+SELECT status, COALESCE(status_changed_at, order_date) AS completed_at INTO order_record
 FROM orders
 WHERE order_id = order_id_param;
 
@@ -224,7 +379,7 @@ END IF;
 END IF;
 
     -- Проверяем, что прошло не более 30 дней
-    days_passed := EXTRACT(DAY FROM (CURRENT_TIMESTAMP - order_record.order_date));
+    days_passed := EXTRACT(DAY FROM (CURRENT_TIMESTAMP - order_record.completed_at));
 
 RETURN days_passed <= 30;
 END;
@@ -283,16 +438,24 @@ END;
 $$ LANGUAGE plpgsql;
 
 -- 7. generateAuditReport - генерация отчета для CSV
+-- Одна строка на заказ: история статусов и аудит агрегируются
+-- подзапросами, поэтому объем результата равен числу заказов за период,
+-- а не произведению записей истории и аудита. end_date включительно.
+-- Меняется тип результата, поэтому старую версию нужно удалить
+DROP FUNCTION IF EXISTS generateAuditReport(DATE, DATE);
+
 CREATE OR REPLACE FUNCTION generateAuditReport(start_date DATE, end_date DATE)
 RETURNS TABLE(
     order_id INTEGER,
     customer_name VARCHAR,
     order_status VARCHAR,
-    status_change VARCHAR,
-    change_date TIMESTAMP,
-    operation_type VARCHAR,
-    operation_date TIMESTAMP,
-    details TEXT
+    total_price DECIMAL,
+    order_date TIMESTAMP,
+    last_status_change TIMESTAMP,
+    status_change_count BIGINT,
+    last_operation VARCHAR,
+    last_operation_at TIMESTAMP,
+    audit_count BIGINT
 ) AS $$
 BEGIN
 RETURN QUERY
@@ -300,64 +463,391 @@ SELECT
     o.order_id,
     u.name as customer_name,
     o.status as order_status,
-    CONCAT(h.old_status, ' -> ', h.new_status) as status_change,
-    h.changed_at as change_date,
-    a.operation as operation_type,
-    a.performed_at as operation_date,
-    COALESCE(a.details, '') as details
+    o.total_price,
+    date_trunc('second', o.order_date)::TIMESTAMP as order_date,
+    date_trunc('second', h.last_change)::TIMESTAMP as last_status_change,
+    COALESCE(h.change_count, 0) as status_change_count,
+    la.operation as last_operation,
+    date_trunc('second', la.performed_at)::TIMESTAMP as last_operation_at,
+    COALESCE(ac.audit_count, 0) as audit_count
 FROM orders o
          JOIN users u ON o.user_id = u.user_id
-         LEFT JOIN order_status_history h ON o.order_id = h.order_id
-         LEFT JOIN audit_log a ON o.order_id = a.entity_id AND a.entity_type = 'order'
-WHERE o.order_date BETWEEN start_date AND end_date
-ORDER BY o.order_id, h.changed_at;
+         LEFT JOIN LATERAL (
+    -- Первая запись истории (old_status IS NULL) - создание, не изменение
+    SELECT MAX(sh.changed_at) as last_change, COUNT(*) as change_count
+    FROM order_status_history sh
+    WHERE sh.order_id = o.order_id AND sh.old_status IS NOT NULL
+    ) h ON TRUE
+         LEFT JOIN LATERAL (
+    SELECT a.operation, a.performed_at
+    FROM audit_log a
+    WHERE a.entity_type = 'order' AND a.entity_id = o.order_id
+    ORDER BY a.performed_at DESC, a.log_id DESC
+    LIMIT 1
+    ) la ON TRUE
+         LEFT JOIN LATERAL (
+    SELECT COUNT(*) as audit_count
+    FROM audit_log a
+    WHERE a.entity_type = 'order' AND a.entity_id = o.order_id
+    ) ac ON TRUE
+WHERE o.order_date >= start_date AND o.order_date < end_date + 1
+ORDER BY o.order_id DESC;
 END;
 $$ LANGUAGE plpgsql;
 
+-- СТРУКТУРИРОВАННЫЙ АУДИТ
+-- action - код действия (совпадает с AuditAction в include/AuditAction.h),
+-- payload - данные операции в JSONB. Выборки по журналу фильтруют по
+-- action, а не по тексту details. NULL в action - записи, сделанные до
+-- появления столбца и не попавшие под перенос ниже.
+DO $$
+BEGIN
+    IF NOT EXISTS (SELECT 1 FROM pg_type WHERE typname = 'audit_action') THEN
+CREATE TYPE audit_action AS ENUM (
+            'order_created', 'order_approved', 'order_canceled', 'order_returned',
+            'order_status_changed', 'order_error', 'product_created', 'product_updated',
+            'product_deleted', 'stock_updated', 'user_deleted'
+        );
+END IF;
+END;
+$$;
+
+ALTER TABLE audit_log
+    ADD COLUMN IF NOT EXISTS action audit_action,
+    ADD COLUMN IF NOT EXISTS payload JSONB;
+
+-- Перенос старых утверждений менеджеров (однократно; повторный запуск
+-- не находит строк с action IS NULL под этим условием)
+UPDATE audit_log
+SET action = 'order_approved'
+WHERE action IS NULL
+  AND entity_type = 'order'
+  AND details LIKE '%утвержден менеджером%';
+
+-- Удаление дублей создания и отмены (однократно): раньше их писали и
+-- процедуры, и триггер audit_order_changes. Остается запись процедуры -
+-- в ней сумма заказа и настоящий исполнитель отмены
+DELETE FROM audit_log t
+WHERE t.entity_type = 'order'
+  AND t.details IN ('Создан новый заказ', 'Заказ отменен')
+  AND EXISTS (
+      SELECT 1 FROM audit_log p
+      WHERE p.entity_type = 'order'
+        AND p.entity_id = t.entity_id
+        AND p.log_id <> t.log_id
+        AND (t.details = 'Создан новый заказ' AND p.details LIKE 'Создан заказ на сумму:%'
+          OR t.details = 'Заказ отменен' AND p.details = 'Заказ отменен администратором')
+  );
+
+-- СВОДКИ ПО ЗАКАЗАМ
+-- orders.items_count - число позиций заказа, user_order_stats - итоги
+-- покупателя. Поддерживаются триггерами 8 и 9 по разнице изменений,
+-- поэтому списки заказов и функции getUserOrderCount/getTotalSpentByUser
+-- не агрегируют order_items и orders при каждом запросе.
+ALTER TABLE orders
+    ADD COLUMN IF NOT EXISTS items_count INTEGER NOT NULL DEFAULT 0;
+
+CREATE TABLE IF NOT EXISTS user_order_stats (
+    user_id INTEGER PRIMARY KEY REFERENCES users(user_id) ON DELETE CASCADE,
+    orders_count INTEGER NOT NULL DEFAULT 0,
+    total_spent DECIMAL(12,2) NOT NULL DEFAULT 0   -- Заказы completed и returned
+);
+
+-- Начальное заполнение (повторный запуск исправляет расхождения)
+UPDATE orders o
+SET items_count = c.items_count
+    FROM (
+        SELECT o2.order_id, COUNT(oi.order_item_id) AS items_count
+        FROM orders o2
+        LEFT JOIN order_items oi ON oi.order_id = o2.order_id
+        GROUP BY o2.order_id
+    ) c
+WHERE o.order_id = c.order_id
+  AND o.items_count <> c.items_count;
+
+INSERT INTO user_order_stats (user_id, orders_count, total_spent)
+SELECT user_id,
+       COUNT(*),
+       COALESCE(SUM(total_price) FILTER (WHERE status IN ('completed', 'returned')), 0)
+FROM orders
+GROUP BY user_id
+ON CONFLICT (user_id) DO UPDATE
+    SET orders_count = EXCLUDED.orders_count,
+        total_spent = EXCLUDED.total_spent;
+
+-- ВХОД В СЕТЕВОЙ СЕРВЕР
+-- OnlineStoreServer сверяет пароль с bcrypt-хешем (pgcrypto). Пользователь
+-- без password_hash по сети не входит. Пароль задается процедурой:
+--   CALL setUserPassword(3, 'длинный пароль');
+CREATE EXTENSION IF NOT EXISTS pgcrypto;
+
+ALTER TABLE users
+    ADD COLUMN IF NOT EXISTS password_hash TEXT;
+
+-- В исходной схеме password_hash NOT NULL и заполнялся чем угодно.
+-- Значения, не являющиеся bcrypt-хешем ($2a$/$2b$/$2y$), сбрасываются:
+-- crypt() с таким "хешем" как солью проверяет пароль слабым алгоритмом
+-- или открытым текстом. Таким пользователям пароль задается заново
+ALTER TABLE users
+    ALTER COLUMN password_hash DROP NOT NULL;
+
+UPDATE users
+SET password_hash = NULL
+WHERE password_hash NOT LIKE '$2_$%';
+
+ALTER TABLE users
+    DROP CONSTRAINT IF EXISTS users_password_hash_bcrypt;
+ALTER TABLE users
+    ADD CONSTRAINT users_password_hash_bcrypt
+        CHECK (password_hash IS NULL OR password_hash LIKE '$2_$%');
+
+CREATE OR REPLACE PROCEDURE setUserPassword(
+    user_id_param INTEGER,
+    password_param TEXT
+)
+LANGUAGE plpgsql
+AS $$
+BEGIN
+    IF length(password_param) < 8 THEN
+        RAISE EXCEPTION 'Пароль короче 8 символов';
+END IF;
+
+UPDATE users
+SET password_hash = crypt(password_param, gen_salt('bf'))
+WHERE user_id = user_id_param;
+
+IF NOT FOUND THEN
+        RAISE EXCEPTION 'Пользователь % не найден', user_id_param;
+END IF;
+END;
+$$;
+
+-- ЗАДАНИЯ ПЕРЕСЧЕТА ЦЕН
+-- Создаются триггером trg_update_order_prices, когда изменение цены
+-- затрагивает слишком много позиций. items_done - прогресс выполнения.
+CREATE TABLE IF NOT EXISTS reprice_jobs (
+    job_id SERIAL PRIMARY KEY,
+    product_id INTEGER NOT NULL REFERENCES products(product_id) ON DELETE CASCADE,
+    status VARCHAR(20) NOT NULL DEFAULT 'queued'
+        CHECK (status IN ('queued', 'running', 'done')),
+    items_total INTEGER,
+    items_done INTEGER NOT NULL DEFAULT 0,
+    created_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    started_at TIMESTAMP,
+    finished_at TIMESTAMP
+);
+
+-- Не больше одного незавершенного задания на товар
+CREATE UNIQUE INDEX IF NOT EXISTS uq_reprice_jobs_open
+    ON reprice_jobs (product_id) WHERE status <> 'done';
+
+-- Процедура processRepriceJobs: выполнение заданий порциями
+-- Каждая порция (batch_size позиций) - отдельная транзакция, поэтому
+-- блокировки заказов держатся недолго, а прогресс виден сразу.
+-- Позиции приводятся к текущей цене товара, так что повторные изменения
+-- цены во время выполнения не теряются. Одновременно работает один
+-- исполнитель (advisory lock). Вызывать вне транзакции:
+--   CALL processRepriceJobs();
+-- (из OnlineStore это делает RepriceWorker, либо по расписанию pg_cron)
+CREATE OR REPLACE PROCEDURE processRepriceJobs(batch_size INTEGER DEFAULT 500)
+LANGUAGE plpgsql
+AS $$
+DECLARE
+job RECORD;
+    batch_count INTEGER;
+BEGIN
+    IF NOT pg_try_advisory_lock(hashtext('processRepriceJobs')) THEN
+        RETURN;
+END IF;
+
+    LOOP
+SELECT * INTO job
+FROM reprice_jobs
+WHERE status <> 'done'
+ORDER BY job_id
+    LIMIT 1;
+EXIT WHEN NOT FOUND;
+
+UPDATE reprice_jobs
+SET status = 'running',
+    started_at = COALESCE(started_at, CURRENT_TIMESTAMP),
+    items_total = (
+        SELECT COUNT(*)
+        FROM order_items oi
+                 JOIN orders o ON o.order_id = oi.order_id
+                 JOIN products p ON p.product_id = oi.product_id
+        WHERE oi.product_id = job.product_id
+          AND o.status = 'pending'
+          AND oi.price <> p.price
+    ) + items_done
+WHERE job_id = job.job_id;
+COMMIT;
+
+LOOP
+            WITH locked AS (
+                SELECT oi.order_item_id, oi.price AS old_price
+                FROM order_items oi
+                JOIN orders o ON o.order_id = oi.order_id
+                JOIN products p ON p.product_id = oi.product_id
+                WHERE oi.product_id = job.product_id
+                  AND o.status = 'pending'
+                  AND oi.price <> p.price
+                ORDER BY oi.order_item_id
+                LIMIT batch_size
+                FOR UPDATE OF oi, o
+            ), changed AS (
+                UPDATE order_items oi
+                SET price = p.price
+                FROM locked l, products p
+                WHERE oi.order_item_id = l.order_item_id
+                  AND p.product_id = oi.product_id
+                RETURNING oi.order_id, oi.quantity * (oi.price - l.old_price) AS delta
+            ), totals AS (
+                UPDATE orders o
+                SET total_price = o.total_price + d.delta
+                FROM (
+                    SELECT order_id, SUM(delta) AS delta
+                    FROM changed
+                    GROUP BY order_id
+                ) d
+                WHERE o.order_id = d.order_id
+            )
+SELECT COUNT(*) INTO batch_count FROM changed;
+
+UPDATE reprice_jobs
+SET items_done = items_done + batch_count
+WHERE job_id = job.job_id;
+COMMIT;
+
+EXIT WHEN batch_count < batch_size;
+END LOOP;
+
+-- Блокировка товара: параллельное изменение цены либо уже видно здесь,
+        -- либо будет выполнено после коммита и увидит задание завершенным
+        PERFORM 1 FROM products WHERE product_id = job.product_id FOR SHARE;
+
+        -- Если позиции снова устарели, задание останется открытым
+UPDATE reprice_jobs
+SET status = 'done', finished_at = CURRENT_TIMESTAMP
+WHERE job_id = job.job_id
+  AND NOT EXISTS (
+    SELECT 1
+    FROM order_items oi
+             JOIN orders o ON o.order_id = oi.order_id
+             JOIN products p ON p.product_id = oi.product_id
+    WHERE oi.product_id = job.product_id
+      AND o.status = 'pending'
+      AND oi.price <> p.price
+);
+COMMIT;
+END LOOP;
+
+    PERFORM pg_advisory_unlock(hashtext('processRepriceJobs'));
+END;
+$$;
+
 -- ТРИГГЕРЫ 
 
--- 1. Триггер для автоматического обновления order_date при изменении статуса
-CREATE OR REPLACE FUNCTION update_order_date_on_status_change()
+-- 1. Триггер времени смены статуса
+-- order_date - время оформления, после вставки не меняется: списки
+-- заказов читаются страницами по ключу (order_date, order_id), и заказ
+-- не должен переходить на другую страницу при смене статуса. Время
+-- последней смены статуса - в status_changed_at (NULL - статус не менялся).
+ALTER TABLE orders
+    ADD COLUMN IF NOT EXISTS status_changed_at TIMESTAMP;
+
+-- Перенос (однократно): прежний триггер переписывал order_date при смене
+-- статуса. Это значение - время последней смены, а время оформления
+-- восстанавливается по первой записи истории статусов
+UPDATE orders o
+SET status_changed_at = o.order_date,
+    order_date = COALESCE((
+        SELECT MIN(h.changed_at)
+        FROM order_status_history h
+        WHERE h.order_id = o.order_id AND h.old_status IS NULL
+    ), o.order_date)
+WHERE o.status_changed_at IS NULL
+  AND o.status <> 'pending';
+
+DROP TRIGGER IF EXISTS trg_update_order_date ON orders;
+DROP FUNCTION IF EXISTS update_order_date_on_status_change();
+
+CREATE OR REPLACE FUNCTION set_status_changed_at()
 RETURNS TRIGGER AS $$
 BEGIN
     IF OLD.status IS DISTINCT FROM NEW.status THEN
-        NEW.order_date = CURRENT_TIMESTAMP;
+        NEW.status_changed_at = CURRENT_TIMESTAMP;
 END IF;
 RETURN NEW;
 END;
 $$ LANGUAGE plpgsql;
 
-CREATE TRIGGER trg_update_order_date
+CREATE TRIGGER trg_set_status_changed_at
     BEFORE UPDATE OF status ON orders
     FOR EACH ROW
-    EXECUTE FUNCTION update_order_date_on_status_change();
+    EXECUTE FUNCTION set_status_changed_at();
 
--- 2. Триггер для обновления total_price при изменении цены продукта
+-- 2. Триггер пересчета заказов при изменении цены продукта
+-- Пересчитываются только заказы в статусе pending (оформленные заказы
+-- сохраняют цену покупки). Сумма заказа меняется на разницу
+-- (новая цена - старая цена позиции) * количество, без SUM() по заказу.
+-- Если позиций больше порога, пересчет уходит в reprice_jobs и
+-- выполняется порциями процедурой processRepriceJobs, а UPDATE товара
+-- не блокирует тысячи заказов.
 CREATE OR REPLACE FUNCTION update_order_prices_on_product_change()
 RETURNS TRIGGER AS $$
+DECLARE
+inline_limit CONSTANT INTEGER := 200;
+    affected_items INTEGER;
 BEGIN
     IF OLD.price IS DISTINCT FROM NEW.price THEN
-        -- Обновляем цену в элементах заказа
-UPDATE order_items oi
-SET price = NEW.price
-    FROM orders o
-WHERE oi.product_id = NEW.product_id
-  AND oi.order_id = o.order_id
-  AND o.status IN ('pending', 'completed');
-
--- Пересчитываем общую сумму заказов
-UPDATE orders o
-SET total_price = (
-    SELECT SUM(oi.quantity * oi.price)
-    FROM order_items oi
-    WHERE oi.order_id = o.order_id
-)
-WHERE o.order_id IN (
-    SELECT DISTINCT order_id
-    FROM order_items
-    WHERE product_id = NEW.product_id
-)
-  AND o.status IN ('pending', 'completed');
+        -- Считаем позиции не дальше порога
+        SELECT COUNT(*) INTO affected_items
+        FROM (
+            SELECT 1
+            FROM order_items oi
+            JOIN orders o ON o.order_id = oi.order_id
+            WHERE oi.product_id = NEW.product_id
+              AND o.status = 'pending'
+            LIMIT inline_limit + 1
+        ) t;
+
+        -- Открытое задание по товару продолжит работу уже с новой ценой
+        IF affected_items > inline_limit
+            OR EXISTS (SELECT 1 FROM reprice_jobs
+                       WHERE product_id = NEW.product_id AND status <> 'done') THEN
+            INSERT INTO reprice_jobs (product_id)
+            VALUES (NEW.product_id)
+            ON CONFLICT (product_id) WHERE status <> 'done' DO NOTHING;
+
+            PERFORM pg_notify('reprice_jobs', NEW.product_id::TEXT);
+
+        ELSIF affected_items > 0 THEN
+            -- Старая цена читается под блокировкой позиции
+            WITH locked AS (
+                SELECT oi.order_item_id, oi.price AS old_price
+                FROM order_items oi
+                JOIN orders o ON o.order_id = oi.order_id
+                WHERE oi.product_id = NEW.product_id
+                  AND o.status = 'pending'
+                  AND oi.price <> NEW.price
+                FOR UPDATE OF oi, o
+            ), changed AS (
+                UPDATE order_items oi
+                SET price = NEW.price
+                FROM locked l
+                WHERE oi.order_item_id = l.order_item_id
+                RETURNING oi.order_id, oi.quantity * (NEW.price - l.old_price) AS delta
+            )
+            UPDATE orders o
+            SET total_price = o.total_price + d.delta
+            FROM (
+                SELECT order_id, SUM(delta) AS delta
+                FROM changed
+                GROUP BY order_id
+            ) d
+            WHERE o.order_id = d.order_id;
+        END IF;
 END IF;
 RETURN NEW;
 END;
@@ -390,18 +880,27 @@ CREATE OR REPLACE FUNCTION audit_product_changes()
 RETURNS TRIGGER AS $$
 BEGIN
     IF TG_OP = 'INSERT' THEN
-        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
+        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action, payload)
         VALUES ('product', NEW.product_id, 'insert', NULL,
-                format('Новый товар: %s, Цена: %s', NEW.name, NEW.price));
+                format('Новый товар: %s, Цена: %s', NEW.name, NEW.price),
+                'product_created',
+                jsonb_build_object('name', NEW.name, 'price', NEW.price,
+                                   'stock_quantity', NEW.stock_quantity));
     ELSIF TG_OP = 'UPDATE' THEN
-        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
+        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action, payload)
         VALUES ('product', NEW.product_id, 'update', NULL,
                 format('Товар обновлен. Название: %s -> %s, Цена: %s -> %s',
-                       OLD.name, NEW.name, OLD.price, NEW.price));
+                       OLD.name, NEW.name, OLD.price, NEW.price),
+                'product_updated',
+                jsonb_build_object('old_name', OLD.name, 'new_name', NEW.name,
+                                   'old_price', OLD.price, 'new_price', NEW.price,
+                                   'old_stock', OLD.stock_quantity,
+                                   'new_stock', NEW.stock_quantity));
     ELSIF TG_OP = 'DELETE' THEN
-        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
+        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action, payload)
         VALUES ('product', OLD.product_id, 'delete', NULL,
-                format('Товар удален: %s', OLD.name));
+                format('Товар удален: %s', OLD.name),
+                'product_deleted', jsonb_build_object('name', OLD.name));
 END IF;
 
 RETURN NEW;
@@ -418,9 +917,10 @@ CREATE OR REPLACE FUNCTION audit_user_changes()
 RETURNS TRIGGER AS $$
 BEGIN
     IF TG_OP = 'DELETE' THEN
-        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
+        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action, payload)
         VALUES ('user', OLD.user_id, 'delete', NULL,
-                format('Пользователь удален: %s (%s)', OLD.name, OLD.email));
+                format('Пользователь удален: %s (%s)', OLD.name, OLD.email),
+                'user_deleted', jsonb_build_object('name', OLD.name, 'email', OLD.email));
 END IF;
 
 RETURN NEW;
@@ -433,30 +933,228 @@ CREATE TRIGGER trg_audit_users
     EXECUTE FUNCTION audit_user_changes();
 
 -- 6. Триггер аудита для заказов
+-- Создание и отмену записывают процедуры createOrder/cancelOrder и методы
+-- cancelOrder в приложении (с настоящим исполнителем); триггер пишет
+-- только возврат, у которого другого автора записи нет.
 CREATE OR REPLACE FUNCTION audit_order_changes()
 RETURNS TRIGGER AS $$
 BEGIN
-    IF TG_OP = 'INSERT' THEN
-        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
-        VALUES ('order', NEW.order_id, 'insert', NEW.user_id,
-                'Создан новый заказ');
-    ELSIF TG_OP = 'UPDATE' THEN
-        IF OLD.status = 'completed' AND NEW.status = 'returned' THEN
-            INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
-            VALUES ('order', NEW.order_id, 'update', NEW.user_id,
-                    'Заказ возвращен');
-        ELSIF OLD.status = 'pending' AND NEW.status = 'canceled' THEN
-            INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details)
-            VALUES ('order', NEW.order_id, 'update', NEW.user_id,
-                    'Заказ отменен');
-END IF;
+    IF OLD.status = 'completed' AND NEW.status = 'returned' THEN
+        INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action, payload)
+        VALUES ('order', NEW.order_id, 'update', NEW.user_id,
+                'Заказ возвращен',
+                'order_returned',
+                jsonb_build_object('old_status', OLD.status, 'new_status', NEW.status));
 END IF;
 
 RETURN NEW;
 END;
 $$ LANGUAGE plpgsql;
 
+DROP TRIGGER IF EXISTS trg_audit_orders ON orders;
 CREATE TRIGGER trg_audit_orders
-    AFTER INSERT OR UPDATE ON orders
+    AFTER UPDATE OF status ON orders
                         FOR EACH ROW
                         EXECUTE FUNCTION audit_order_changes();
+
+-- 7. Триггер уведомления кэша каталога об изменении товара
+-- Payload - product_id. Уведомления доставляются после коммита,
+-- одинаковые в одной транзакции объединяются сервером.
+CREATE OR REPLACE FUNCTION notify_product_change()
+RETURNS TRIGGER AS $$
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        PERFORM pg_notify('product_changes', OLD.product_id::TEXT);
+ELSE
+        PERFORM pg_notify('product_changes', NEW.product_id::TEXT);
+END IF;
+RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER trg_notify_product_changes
+    AFTER INSERT OR UPDATE OR DELETE ON products
+    FOR EACH ROW
+    EXECUTE FUNCTION notify_product_change();
+
+-- 8. Триггеры числа позиций заказа (orders.items_count)
+-- Уровень оператора: один UPDATE orders на оператор, а не на строку,
+-- поэтому INSERT всей корзины в createOrder обновляет заказ один раз.
+CREATE OR REPLACE FUNCTION maintain_order_items_count()
+RETURNS TRIGGER AS $$
+BEGIN
+    IF TG_OP = 'INSERT' THEN
+UPDATE orders o
+SET items_count = o.items_count + d.delta
+    FROM (SELECT order_id, COUNT(*) AS delta FROM new_items GROUP BY order_id) d
+WHERE o.order_id = d.order_id;
+ELSIF TG_OP = 'DELETE' THEN
+UPDATE orders o
+SET items_count = o.items_count - d.delta
+    FROM (SELECT order_id, COUNT(*) AS delta FROM old_items GROUP BY order_id) d
+WHERE o.order_id = d.order_id;
+ELSE
+        -- Позиция могла перейти в другой заказ
+UPDATE orders o
+SET items_count = o.items_count + d.delta
+    FROM (
+        SELECT order_id, SUM(delta) AS delta
+        FROM (
+            SELECT order_id, 1 AS delta FROM new_items
+            UNION ALL
+            SELECT order_id, -1 FROM old_items
+        ) c
+        GROUP BY order_id
+        HAVING SUM(delta) <> 0
+    ) d
+WHERE o.order_id = d.order_id;
+END IF;
+RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER trg_order_items_count_insert
+    AFTER INSERT ON order_items
+    REFERENCING NEW TABLE AS new_items
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION maintain_order_items_count();
+
+CREATE TRIGGER trg_order_items_count_update
+    AFTER UPDATE ON order_items
+    REFERENCING OLD TABLE AS old_items NEW TABLE AS new_items
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION maintain_order_items_count();
+
+CREATE TRIGGER trg_order_items_count_delete
+    AFTER DELETE ON order_items
+    REFERENCING OLD TABLE AS old_items
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION maintain_order_items_count();
+
+-- 9. Триггеры итогов покупателя (user_order_stats)
+-- Вклад заказа: 1 в orders_count и total_price в total_spent, если заказ
+-- completed или returned. Применяется разница вкладов новых и старых строк;
+-- обновления, не меняющие итоги (например, items_count), не пишут ничего.
+CREATE OR REPLACE FUNCTION maintain_user_order_stats()
+RETURNS TRIGGER AS $$
+BEGIN
+    IF TG_OP = 'INSERT' THEN
+        INSERT INTO user_order_stats (user_id, orders_count, total_spent)
+SELECT user_id,
+       COUNT(*),
+       COALESCE(SUM(total_price) FILTER (WHERE status IN ('completed', 'returned')), 0)
+FROM new_orders
+GROUP BY user_id
+ON CONFLICT (user_id) DO UPDATE
+    SET orders_count = user_order_stats.orders_count + EXCLUDED.orders_count,
+        total_spent = user_order_stats.total_spent + EXCLUDED.total_spent;
+ELSIF TG_OP = 'DELETE' THEN
+UPDATE user_order_stats us
+SET orders_count = us.orders_count - d.orders_count,
+    total_spent = us.total_spent - d.total_spent
+    FROM (
+        SELECT user_id,
+               COUNT(*) AS orders_count,
+               COALESCE(SUM(total_price) FILTER (WHERE status IN ('completed', 'returned')), 0)
+                   AS total_spent
+        FROM old_orders
+        GROUP BY user_id
+    ) d
+WHERE us.user_id = d.user_id;
+ELSE
+        INSERT INTO user_order_stats (user_id, orders_count, total_spent)
+SELECT user_id, SUM(orders_count), SUM(total_spent)
+FROM (
+         SELECT user_id, 1 AS orders_count,
+                CASE WHEN status IN ('completed', 'returned') THEN total_price ELSE 0 END AS total_spent
+         FROM new_orders
+         UNION ALL
+         SELECT user_id, -1,
+                CASE WHEN status IN ('completed', 'returned') THEN -total_price ELSE 0 END
+         FROM old_orders
+     ) d
+GROUP BY user_id
+HAVING SUM(orders_count) <> 0 OR SUM(total_spent) <> 0
+ON CONFLICT (user_id) DO UPDATE
+    SET orders_count = user_order_stats.orders_count + EXCLUDED.orders_count,
+        total_spent = user_order_stats.total_spent + EXCLUDED.total_spent;
+END IF;
+RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER trg_user_order_stats_insert
+    AFTER INSERT ON orders
+    REFERENCING NEW TABLE AS new_orders
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION maintain_user_order_stats();
+
+CREATE TRIGGER trg_user_order_stats_update
+    AFTER UPDATE ON orders
+    REFERENCING OLD TABLE AS old_orders NEW TABLE AS new_orders
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION maintain_user_order_stats();
+
+CREATE TRIGGER trg_user_order_stats_delete
+    AFTER DELETE ON orders
+    REFERENCING OLD TABLE AS old_orders
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION maintain_user_order_stats();
+
+-- ИНДЕКСЫ
+-- Вторичные индексы под фильтры и сортировки запросов из src/User.cpp.
+-- Проверка планов: sql/plan_check.sql
+
+-- Списки читаются постранично по ключу (дата, id): id в конце индекса
+-- делает порядок однозначным, и страница после курсора - диапазон индекса.
+-- Ключ устойчив, потому что order_date не меняется после вставки
+-- (см. триггер 1). Прежние индексы без id заменены
+DROP INDEX IF EXISTS idx_orders_user_date;
+DROP INDEX IF EXISTS idx_orders_status_date;
+DROP INDEX IF EXISTS idx_orders_order_date;
+
+-- Заказы покупателя (orders_by_user_*)
+CREATE INDEX IF NOT EXISTS idx_orders_user_date_id
+    ON orders (user_id, order_date DESC, order_id DESC);
+
+-- Заказы по статусу (orders_pending_*, orders_approved_by_manager)
+CREATE INDEX IF NOT EXISTS idx_orders_status_date_id
+    ON orders (status, order_date, order_id);
+
+-- Все заказы (orders_all_*) и отчет за период (generateAuditReport)
+CREATE INDEX IF NOT EXISTS idx_orders_date_id
+    ON orders (order_date, order_id);
+
+-- Позиции заказа (OrderHistory, cancelOrder, каскадное удаление заказа)
+CREATE INDEX IF NOT EXISTS idx_order_items_order
+    ON order_items (order_id) INCLUDE (order_item_id);
+
+-- Пересчет цен по товару (trg_update_order_prices)
+CREATE INDEX IF NOT EXISTS idx_order_items_product
+    ON order_items (product_id);
+
+-- Аудит сущности: последняя операция и число записей (generateAuditReport)
+CREATE INDEX IF NOT EXISTS idx_audit_log_entity
+    ON audit_log (entity_type, entity_id, performed_at DESC);
+
+-- Аудит пользователя (getAuditLogByUser)
+CREATE INDEX IF NOT EXISTS idx_audit_log_performed_by
+    ON audit_log (performed_by, performed_at DESC);
+
+-- Действия пользователя определенного типа (orders_approved_by_manager):
+-- выборка - диапазон индекса, entity_id читается без обращения к таблице
+CREATE INDEX IF NOT EXISTS idx_audit_log_performer_action
+    ON audit_log (performed_by, action, entity_id);
+
+-- Последние записи аудита (audit_recent_*), постранично
+DROP INDEX IF EXISTS idx_audit_log_performed_at;
+CREATE INDEX IF NOT EXISTS idx_audit_log_performed_at_id
+    ON audit_log (performed_at DESC, log_id DESC);
+
+-- История статусов заказа (getOrderStatusHistory, generateAuditReport)
+CREATE INDEX IF NOT EXISTS idx_order_status_history_order
+    ON order_status_history (order_id, changed_at);
+
+-- Товары в наличии (products_available)
+CREATE INDEX IF NOT EXISTS idx_products_in_stock
+    ON products (product_id) WHERE stock_quantity > 0;
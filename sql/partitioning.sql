@@ -0,0 +1,280 @@
+-- Партиционирование журналов по месяцам
+-- audit_log (по performed_at) и order_status_history (по changed_at)
+-- секционируются по диапазону: одна секция на календарный месяц.
+-- Запросы за последние дни читают одну-две секции, а удаление старых
+-- данных - это DETACH/DROP секции вместо массового DELETE.
+--
+-- Выполняется после database_setup.sql:
+--   psql -v ON_ERROR_STOP=1 -d online_store -f sql/partitioning.sql
+-- Повторный запуск безопасен: уже секционированные таблицы не трогаются.
+-- Обслуживание (создание будущих секций и отсоединение старых):
+--   CALL maintainPartitions();
+-- Его по расписанию вызывает OnlineStoreServer (PartitionMaintainer).
+-- Без сервера добавьте вызов в cron или pg_cron, например раз в сутки.
+
+-- Прежние версии с другим набором параметров
+DROP PROCEDURE IF EXISTS maintainPartitions(INTEGER, INTEGER, INTEGER);
+DROP FUNCTION IF EXISTS detachOldPartitions(TEXT, INTEGER, BOOLEAN);
+
+-- 1. ensureMonthlyPartitions - секции от from_month до текущего месяца + months_ahead
+-- Имя секции: <таблица>_pYYYY_MM
+-- Если строки месяца уже попали в секцию DEFAULT (обслуживание долго не
+-- запускалось), секция месяца не создается, пока они там: PostgreSQL
+-- запрещает такой CREATE. Поэтому строки сначала переносятся во временную
+-- таблицу и после создания секции вставляются обратно.
+CREATE OR REPLACE FUNCTION ensureMonthlyPartitions(
+    parent_table TEXT,
+    from_month DATE,
+    months_ahead INTEGER
+)
+RETURNS INTEGER AS $$
+DECLARE
+month_start DATE := date_trunc('month', from_month)::DATE;
+    last_month DATE := (date_trunc('month', CURRENT_DATE) + make_interval(months => months_ahead))::DATE;
+    default_name TEXT := parent_table || '_default';
+    key_column TEXT;
+    partition_name TEXT;
+    month_end DATE;
+    has_default_rows BOOLEAN;
+    created INTEGER := 0;
+BEGIN
+    -- Ключ секционирования (performed_at / changed_at)
+    SELECT a.attname INTO key_column
+    FROM pg_partitioned_table p
+    JOIN pg_attribute a ON a.attrelid = p.partrelid AND a.attnum = p.partattrs[0]
+    WHERE p.partrelid = parent_table::regclass;
+
+    WHILE month_start <= last_month LOOP
+        partition_name := format('%s_p%s', parent_table, to_char(month_start, 'YYYY_MM'));
+        month_end := (month_start + INTERVAL '1 month')::DATE;
+
+        IF to_regclass(partition_name) IS NULL THEN
+            has_default_rows := FALSE;
+            IF to_regclass(default_name) IS NOT NULL THEN
+                EXECUTE format('SELECT EXISTS (SELECT 1 FROM %I WHERE %I >= %L AND %I < %L)',
+                               default_name, key_column, month_start, key_column, month_end)
+                    INTO has_default_rows;
+            END IF;
+
+            IF has_default_rows THEN
+                EXECUTE format('CREATE TEMP TABLE partition_move (LIKE %I)', default_name);
+                EXECUTE format(
+                    'WITH moved AS (DELETE FROM %I WHERE %I >= %L AND %I < %L RETURNING *) '
+                    'INSERT INTO partition_move SELECT * FROM moved',
+                    default_name, key_column, month_start, key_column, month_end);
+            END IF;
+
+            EXECUTE format(
+                'CREATE TABLE %I PARTITION OF %I FOR VALUES FROM (%L) TO (%L)',
+                partition_name, parent_table, month_start, month_end);
+            created := created + 1;
+
+            IF has_default_rows THEN
+                EXECUTE format('INSERT INTO %I OVERRIDING SYSTEM VALUE SELECT * FROM partition_move',
+                               parent_table);
+                DROP TABLE partition_move;
+                RAISE NOTICE '%: строки за % перенесены из %', partition_name,
+                    to_char(month_start, 'YYYY-MM'), default_name;
+            END IF;
+END IF;
+
+        month_start := (month_start + INTERVAL '1 month')::DATE;
+END LOOP;
+
+RETURN created;
+END;
+$$ LANGUAGE plpgsql;
+
+-- 2. detachOldPartitions - отсоединение секций старше keep_months месяцев
+-- При drop_detached = TRUE секция удаляется (вместе с оставшимися от
+-- прежних запусков отсоединенными секциями старше срока), иначе остается
+-- обычной таблицей-архивом <таблица>_pYYYY_MM.
+-- DETACH берет ACCESS EXCLUSIVE на родителя: ожидание блокировки
+-- ограничено lock_timeout, чтобы не держать очередь писателей журнала
+-- за долгой транзакцией. Не дождавшаяся секция пропускается до
+-- следующего запуска.
+CREATE OR REPLACE FUNCTION detachOldPartitions(
+    parent_table TEXT,
+    keep_months INTEGER,
+    drop_detached BOOLEAN DEFAULT FALSE,
+    lock_wait INTERVAL DEFAULT '2 seconds'
+)
+RETURNS INTEGER AS $$
+DECLARE
+cutoff DATE := (date_trunc('month', CURRENT_DATE) - make_interval(months => keep_months))::DATE;
+    partition_record RECORD;
+    detached INTEGER := 0;
+BEGIN
+    -- Действует до конца транзакции вызова
+    PERFORM set_config('lock_timeout', (EXTRACT(EPOCH FROM lock_wait) * 1000)::BIGINT::TEXT, TRUE);
+
+FOR partition_record IN
+SELECT c.relname
+FROM pg_inherits i
+         JOIN pg_class c ON c.oid = i.inhrelid
+WHERE i.inhparent = parent_table::regclass
+  AND c.relname ~ ('^' || parent_table || '_p[0-9]{4}_[0-9]{2}$')
+  AND to_date(right(c.relname, 7), 'YYYY_MM') < cutoff
+ORDER BY c.relname
+    LOOP
+        BEGIN
+            EXECUTE format('ALTER TABLE %I DETACH PARTITION %I', parent_table, partition_record.relname);
+
+            IF drop_detached THEN
+                EXECUTE format('DROP TABLE %I', partition_record.relname);
+END IF;
+
+            detached := detached + 1;
+EXCEPTION WHEN lock_not_available THEN
+            RAISE WARNING '%: журнал занят, секция % будет отсоединена при следующем запуске',
+                parent_table, partition_record.relname;
+END;
+END LOOP;
+
+    -- Архивы, отсоединенные прежними запусками без удаления
+    IF drop_detached THEN
+        FOR partition_record IN
+SELECT c.relname
+FROM pg_class c
+WHERE c.relkind = 'r'
+  AND c.relnamespace = (SELECT relnamespace FROM pg_class WHERE oid = parent_table::regclass)
+  AND c.relname ~ ('^' || parent_table || '_p[0-9]{4}_[0-9]{2}$')
+  AND NOT EXISTS (SELECT 1 FROM pg_inherits i WHERE i.inhrelid = c.oid)
+  AND to_date(right(c.relname, 7), 'YYYY_MM') < cutoff
+    LOOP
+            EXECUTE format('DROP TABLE %I', partition_record.relname);
+END LOOP;
+END IF;
+
+RETURN detached;
+END;
+$$ LANGUAGE plpgsql;
+
+-- 3. maintainPartitions - плановое обслуживание обоих журналов
+-- Аудит хранится год, история статусов - два года. Старше срока данные
+-- удаляются; для архивирования вызовите с purge_expired => FALSE
+-- (секции останутся отдельными таблицами, их вынос - забота архивации).
+CREATE OR REPLACE PROCEDURE maintainPartitions(
+    months_ahead INTEGER DEFAULT 3,
+    audit_keep_months INTEGER DEFAULT 12,
+    history_keep_months INTEGER DEFAULT 24,
+    purge_expired BOOLEAN DEFAULT TRUE
+)
+LANGUAGE plpgsql
+AS $$
+BEGIN
+    -- Несколько серверов не обслуживают секции одновременно
+    IF NOT pg_try_advisory_xact_lock(hashtext('maintainPartitions')) THEN
+        RAISE NOTICE 'Обслуживание секций уже выполняется';
+        RETURN;
+END IF;
+
+    PERFORM ensureMonthlyPartitions('audit_log', CURRENT_DATE, months_ahead);
+    PERFORM ensureMonthlyPartitions('order_status_history', CURRENT_DATE, months_ahead);
+
+    PERFORM detachOldPartitions('audit_log', audit_keep_months, purge_expired);
+    PERFORM detachOldPartitions('order_status_history', history_keep_months, purge_expired);
+END;
+$$;
+
+-- 4. partitionByMonth - перевод существующей таблицы в секционированную
+-- Таблица переименовывается в <таблица>_old, создается секционированная
+-- копия структуры, данные переносятся, старая таблица удаляется.
+-- Первичный ключ секционированной таблицы обязан включать ключ секции,
+-- поэтому он становится (id_column, time_column).
+CREATE OR REPLACE PROCEDURE partitionByMonth(
+    table_name_param TEXT,
+    id_column TEXT,
+    time_column TEXT
+)
+LANGUAGE plpgsql
+AS $$
+DECLARE
+old_table TEXT := table_name_param || '_old';
+    first_month DATE;
+    id_sequence TEXT;
+    constraint_record RECORD;
+    index_record RECORD;
+BEGIN
+    IF (SELECT relkind FROM pg_class WHERE oid = table_name_param::regclass) = 'p' THEN
+        RAISE NOTICE '% уже секционирована', table_name_param;
+        RETURN;
+END IF;
+
+EXECUTE format('ALTER TABLE %I RENAME TO %I', table_name_param, old_table);
+
+-- Структура, умолчания и CHECK-ограничения без индексов
+EXECUTE format(
+        'CREATE TABLE %I (LIKE %I INCLUDING DEFAULTS INCLUDING IDENTITY INCLUDING CONSTRAINTS) '
+        'PARTITION BY RANGE (%I)',
+        table_name_param, old_table, time_column);
+EXECUTE format('ALTER TABLE %I ADD PRIMARY KEY (%I, %I)',
+               table_name_param, id_column, time_column);
+
+-- Внешние ключи переносятся как есть
+FOR constraint_record IN
+SELECT conname, pg_get_constraintdef(oid) AS definition
+FROM pg_constraint
+WHERE conrelid = old_table::regclass AND contype = 'f'
+    LOOP
+        EXECUTE format('ALTER TABLE %I ADD CONSTRAINT %I %s',
+                       table_name_param, constraint_record.conname, constraint_record.definition);
+END LOOP;
+
+    -- Вторичные индексы создаются на родителе и наследуются секциями
+FOR index_record IN
+SELECT i.relname AS index_name, pg_get_indexdef(i.oid) AS definition
+FROM pg_index x
+         JOIN pg_class i ON i.oid = x.indexrelid
+WHERE x.indrelid = old_table::regclass AND NOT x.indisprimary AND NOT x.indisunique
+    LOOP
+        EXECUTE format('DROP INDEX %I', index_record.index_name);
+EXECUTE regexp_replace(index_record.definition, ' ON \S+ USING ',
+                       ' ON ' || quote_ident(table_name_param) || ' USING ');
+END LOOP;
+
+    -- Секции на весь диапазон существующих данных и три месяца вперед
+EXECUTE format('SELECT COALESCE(MIN(%I)::DATE, CURRENT_DATE) FROM %I', time_column, old_table)
+    INTO first_month;
+PERFORM ensureMonthlyPartitions(table_name_param, first_month, 3);
+
+    -- Строки вне созданных секций (например, с датой в будущем)
+EXECUTE format('CREATE TABLE %I PARTITION OF %I DEFAULT',
+               table_name_param || '_default', table_name_param);
+
+EXECUTE format('INSERT INTO %I OVERRIDING SYSTEM VALUE SELECT * FROM %I', table_name_param, old_table);
+
+-- Счетчик идентификаторов продолжает нумерацию старой таблицы.
+-- Последовательность SERIAL переходит к новой таблице, чтобы не удалиться
+-- вместе со старой (у IDENTITY-столбца своя новая последовательность)
+id_sequence := pg_get_serial_sequence(old_table, id_column);
+    IF id_sequence IS NOT NULL AND NOT EXISTS (
+        SELECT 1 FROM pg_attribute
+        WHERE attrelid = old_table::regclass AND attname = id_column AND attidentity <> ''
+    ) THEN
+        EXECUTE format('ALTER SEQUENCE %s OWNED BY %I.%I', id_sequence, table_name_param, id_column);
+END IF;
+
+    id_sequence := pg_get_serial_sequence(table_name_param, id_column);
+    IF id_sequence IS NOT NULL THEN
+        EXECUTE format('SELECT setval(%L, COALESCE((SELECT MAX(%I) FROM %I), 0) + 1, FALSE)',
+                       id_sequence, id_column, table_name_param);
+END IF;
+
+EXECUTE format('DROP TABLE %I', old_table);
+END;
+$$;
+
+-- МИГРАЦИЯ
+BEGIN;
+
+-- Журналы блокируются на время переноса, чтобы не потерять записи триггеров
+LOCK TABLE audit_log, order_status_history IN ACCESS EXCLUSIVE MODE;
+
+CALL partitionByMonth('audit_log', 'log_id', 'performed_at');
+CALL partitionByMonth('order_status_history', 'history_id', 'changed_at');
+
+COMMIT;
+
+ANALYZE audit_log;
+ANALYZE order_status_history;
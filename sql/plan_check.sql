@@ -0,0 +1,75 @@
+-- Тестовые данные для проверки планов запросов
+-- Выполняется программой OnlineStorePlanCheck (src/plan_check_main.cpp)
+-- внутри ее транзакции, которая откатывается в конце:
+--   STORE_DSN="dbname=online_store" build/OnlineStorePlanCheck sql/plan_check.sql
+-- Временные таблицы plan_* передают программе ID тестовых строк.
+-- Нужны хотя бы один товар в таблице products.
+
+-- ТЕСТОВЫЕ ДАННЫЕ
+-- Пропорции близки к рабочим: много покупателей, мало заказов в 'pending'
+
+INSERT INTO users (name, email, role)
+SELECT 'plan_check_' || g, 'plan_check_' || g || '@example.com', 'customer'
+FROM generate_series(1, 5000) g;
+
+CREATE TEMP TABLE plan_users ON COMMIT DROP AS
+SELECT array_agg(user_id) AS ids FROM users;
+
+CREATE TEMP TABLE plan_products ON COMMIT DROP AS
+SELECT array_agg(product_id) AS ids FROM products;
+
+INSERT INTO orders (user_id, status, total_price, order_date)
+SELECT u.ids[1 + (g % array_length(u.ids, 1))],
+       CASE WHEN g % 50 = 0 THEN 'pending'
+            WHEN g % 10 = 0 THEN 'canceled'
+            ELSE 'completed' END,
+       (g % 1000) * 10.00,
+       CURRENT_TIMESTAMP - (g % 365) * INTERVAL '1 day'
+FROM generate_series(1, 200000) g, plan_users u;
+
+CREATE TEMP TABLE plan_orders ON COMMIT DROP AS
+SELECT min(order_id) AS first_id, max(order_id) AS last_id FROM orders;
+
+INSERT INTO order_items (order_id, product_id, quantity, price)
+SELECT o.first_id + (g % (o.last_id - o.first_id + 1)),
+       p.ids[1 + (g % array_length(p.ids, 1))],
+       1 + g % 3,
+       100.00
+FROM generate_series(1, 600000) g, plan_orders o, plan_products p;
+
+INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, action)
+SELECT 'order',
+       o.first_id + (g % (o.last_id - o.first_id + 1)),
+       'update',
+       u.ids[1 + (g % array_length(u.ids, 1))],
+       CASE WHEN g % 3 = 0 THEN 'Заказ утвержден менеджером' ELSE 'Статус изменен' END,
+       CASE WHEN g % 3 = 0 THEN 'order_approved' ELSE 'order_status_changed' END::audit_action
+FROM generate_series(1, 500000) g, plan_orders o, plan_users u;
+
+INSERT INTO order_status_history (order_id, old_status, new_status, changed_by)
+SELECT o.first_id + (g % (o.last_id - o.first_id + 1)),
+       'pending', 'completed',
+       u.ids[1 + (g % array_length(u.ids, 1))]
+FROM generate_series(1, 200000) g, plan_orders o, plan_users u;
+
+-- Товар с несколькими позициями в ожидающих заказах: изменение его цены
+-- пересчитывается триггером сразу, без задания processRepriceJobs
+INSERT INTO products (name, price, stock_quantity)
+VALUES ('plan_check_small', 100.00, 1000);
+
+CREATE TEMP TABLE plan_small_product ON COMMIT DROP AS
+SELECT product_id FROM products WHERE name = 'plan_check_small'
+ORDER BY product_id DESC LIMIT 1;
+
+INSERT INTO order_items (order_id, product_id, quantity, price)
+SELECT o.order_id, s.product_id, 1, 100.00
+FROM (SELECT order_id FROM orders WHERE status = 'pending' ORDER BY order_id LIMIT 10) o,
+     plan_small_product s;
+
+ANALYZE users;
+ANALYZE products;
+ANALYZE orders;
+ANALYZE order_items;
+ANALYZE audit_log;
+ANALYZE order_status_history;
+ANALYZE user_order_stats;
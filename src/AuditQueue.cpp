@@ -0,0 +1,172 @@
+// src/AuditQueue.cpp
+#include "../include/AuditQueue.h"
+#include "../include/DatabaseConnection.h"
+#include "../include/Logger.h"
+#include <algorithm>
+
+AuditQueue::AuditQueue(std::shared_ptr<DatabaseConnection<std::string>> db,
+                       const AuditQueueOptions& options)
+    : db(std::move(db)), options(options) {
+    if (this->options.batchSize == 0) {
+        this->options.batchSize = 1;
+    }
+    if (this->options.capacity < this->options.batchSize) {
+        this->options.capacity = this->options.batchSize;
+    }
+    pending.reserve(this->options.batchSize);
+    worker = std::thread(&AuditQueue::workerLoop, this);
+}
+
+AuditQueue::~AuditQueue() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    workCondition.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool AuditQueue::enqueue(AuditEvent event) {
+    bool sync = options.durability == AuditDurability::Sync;
+    std::promise<bool> written;
+    std::future<bool> done = written.get_future();
+
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        spaceCondition.wait(lock, [this] {
+            return pending.size() < options.capacity || stopping;
+        });
+        if (stopping) {
+            return false;
+        }
+
+        pending.push_back(Entry{std::move(event), sync ? &written : nullptr});
+        ++enqueuedCount;
+
+        // Поток будится сразу, если набран пакет или кто-то ждет коммита
+        if (pending.size() < options.batchSize && !sync) {
+            return true;
+        }
+    }
+    workCondition.notify_one();
+
+    return sync ? done.get() : true;
+}
+
+void AuditQueue::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    std::uint64_t target = enqueuedCount;
+    flushRequested = true;
+    workCondition.notify_one();
+
+    flushedCondition.wait(lock, [this, target] {
+        return writtenCount >= target;
+    });
+}
+
+std::size_t AuditQueue::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return static_cast<std::size_t>(enqueuedCount - writtenCount);
+}
+
+std::size_t AuditQueue::getFailedCount() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return failedCount;
+}
+
+void AuditQueue::workerLoop() {
+    std::vector<Entry> batch;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            // Ждем полный пакет, но не дольше flushInterval
+            // (в режиме Sync - сразу: пока пишется пакет, копится следующий)
+            workCondition.wait_for(lock, options.flushInterval, [this] {
+                return stopping || flushRequested || pending.size() >= options.batchSize ||
+                       (options.durability == AuditDurability::Sync && !pending.empty());
+            });
+
+            if (pending.empty()) {
+                flushRequested = false;
+                if (stopping) {
+                    break;
+                }
+                continue;
+            }
+
+            // Забираем всю очередь, производители продолжают в пустой вектор
+            batch.swap(pending);
+            flushRequested = false;
+        }
+        spaceCondition.notify_all();
+
+        std::size_t failed = 0;
+        for (std::size_t begin = 0; begin < batch.size(); begin += options.batchSize) {
+            std::size_t end = std::min(batch.size(), begin + options.batchSize);
+            bool ok = writeBatch(batch, begin, end);
+            if (!ok) {
+                failed += end - begin;
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                if (batch[i].written) {
+                    batch[i].written->set_value(ok);
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            writtenCount += batch.size();
+            failedCount += failed;
+        }
+        flushedCondition.notify_all();
+        batch.clear();
+    }
+}
+
+// Один многострочный INSERT на пакет: столбцы передаются массивами
+bool AuditQueue::writeBatch(const std::vector<Entry>& batch, std::size_t begin, std::size_t end) {
+    std::size_t count = end - begin;
+    std::vector<std::string> entityTypes, operations, details;
+    std::vector<std::string_view> actions;
+    std::vector<std::optional<std::string>> payloads;
+    std::vector<std::optional<int>> entityIds;
+    std::vector<int> performedBy;
+    std::vector<double> performedAt;
+
+    entityTypes.reserve(count);
+    operations.reserve(count);
+    details.reserve(count);
+    actions.reserve(count);
+    payloads.reserve(count);
+    entityIds.reserve(count);
+    performedBy.reserve(count);
+    performedAt.reserve(count);
+
+    for (std::size_t i = begin; i < end; ++i) {
+        const AuditEvent& event = batch[i].event;
+        entityTypes.push_back(event.entityType);
+        entityIds.push_back(event.entityId);
+        operations.push_back(event.operation);
+        performedBy.push_back(event.performedBy);
+        details.push_back(event.details);
+        actions.push_back(toString(event.action));
+        payloads.push_back(event.payload);
+        performedAt.push_back(std::chrono::duration<double>(
+            event.performedAt.time_since_epoch()).count());
+    }
+
+    bool ok = db->executePreparedNonQuery("audit_insert_batch",
+                                          entityTypes, entityIds, operations,
+                                          performedBy, details, performedAt,
+                                          actions, payloads);
+    if (!ok) {
+        LOG_ERROR("Не удалось записать пакет аудита из " << count << " событий");
+    } else {
+        LOG_DEBUG("Записан пакет аудита: " << count << " событий");
+    }
+    return ok;
+}
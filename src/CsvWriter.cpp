@@ -0,0 +1,94 @@
+// src/CsvWriter.cpp
+#include "../include/CsvWriter.h"
+#include "../include/Logger.h"
+#include <cstdio>
+
+CsvWriter::CsvWriter(const std::string& filename, char delimiter, std::size_t bufferSize)
+    : filename(filename), tempFilename(filename + ".tmp"),
+      bufferSize(bufferSize), delimiter(delimiter) {
+    file.open(tempFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR("Не удалось открыть файл отчета: " << tempFilename);
+    }
+    buffer.reserve(bufferSize + 1024);
+}
+
+CsvWriter::~CsvWriter() {
+    if (!closed && file.is_open()) {
+        file.close();
+        std::remove(tempFilename.c_str());
+    }
+}
+
+void CsvWriter::appendEscaped(std::string_view field) {
+    bool needsQuotes = false;
+    for (char c : field) {
+        if (c == delimiter || c == '"' || c == '\n' || c == '\r') {
+            needsQuotes = true;
+            break;
+        }
+    }
+    if (!needsQuotes) {
+        buffer.append(field.data(), field.size());
+        return;
+    }
+
+    buffer += '"';
+    for (char c : field) {
+        if (c == '"') {
+            buffer += '"';
+        }
+        buffer += c;
+    }
+    buffer += '"';
+}
+
+bool CsvWriter::flushBuffer() {
+    if (!buffer.empty() && file.is_open()) {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+    buffer.clear();
+    return file.good();
+}
+
+void CsvWriter::writeField(std::string_view field) {
+    if (rowStarted) {
+        buffer += delimiter;
+    }
+    appendEscaped(field);
+    rowStarted = true;
+}
+
+void CsvWriter::endRow() {
+    buffer += '\n';
+    rowStarted = false;
+    ++rowCount;
+
+    if (buffer.size() >= bufferSize) {
+        flushBuffer();
+    }
+}
+
+void CsvWriter::writeRow(std::initializer_list<std::string_view> fields) {
+    for (auto field : fields) {
+        writeField(field);
+    }
+    endRow();
+}
+
+bool CsvWriter::close() {
+    if (closed || !file.is_open()) {
+        return false;
+    }
+
+    bool ok = flushBuffer();
+    file.close();
+    closed = true;
+
+    if (!ok || std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        LOG_ERROR("Ошибка записи файла отчета: " << filename);
+        std::remove(tempFilename.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,173 @@
+// src/Logger.cpp
+#include "../include/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace {
+    const char* levelName(LogLevel level) {
+        switch (level) {
+            case LogLevel::Debug:   return "DEBUG";
+            case LogLevel::Info:    return "INFO";
+            case LogLevel::Warning: return "WARNING";
+            case LogLevel::Error:   return "ERROR";
+            default:                return "";
+        }
+    }
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : slots(new Slot[CAPACITY]), output(stderr) {
+    // Слот i свободен для записи с позиции i
+    for (std::size_t i = 0; i < CAPACITY; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running.store(false, std::memory_order_release);
+    }
+    wakeCondition.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void Logger::setOutput(std::FILE* file) {
+    output.store(file ? file : stderr, std::memory_order_release);
+}
+
+// Запись в ограниченную MPMC-очередь (схема Вьюкова):
+// слот доступен производителю, когда его sequence равен позиции
+void Logger::write(LogLevel level, std::string_view message) {
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    while (true) {
+        slot = &slots[pos & (CAPACITY - 1)];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Буфер полон - не ждем, отбрасываем сообщение
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Обрезаем длинное сообщение, не разрывая символ UTF-8
+    std::size_t length = std::min(message.size(), MESSAGE_SIZE);
+    if (length < message.size()) {
+        while (length > 0 && (static_cast<unsigned char>(message[length]) & 0xC0) == 0x80) {
+            --length;
+        }
+    }
+
+    slot->level = level;
+    slot->time = std::chrono::system_clock::now();
+    slot->length = length;
+    std::memcpy(slot->text, message.data(), length);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // Будим поток записи, только если буфер был пуст: он все прочитал и
+    // спит или собирается уснуть. Барьер в паре с барьером в writerLoop:
+    // либо здесь видна его позиция, либо он увидит это сообщение
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (dequeuePos.load(std::memory_order_relaxed) == pos) {
+        { std::lock_guard<std::mutex> lock(wakeMutex); }
+        wakeCondition.notify_one();
+    }
+}
+
+// Готово ли следующее сообщение (вызывается только фоновым потоком)
+bool Logger::hasPending() const {
+    std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    return slots[pos & (CAPACITY - 1)].sequence.load(std::memory_order_acquire) == pos + 1;
+}
+
+// Забираем все готовые сообщения в буфер (вызывается только фоновым потоком)
+bool Logger::drain(std::string& buffer) {
+    bool any = false;
+    std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+
+    while (true) {
+        Slot& slot = slots[pos & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            break;
+        }
+
+        // Формат: [2024-01-15 10:30:15] INFO: сообщение
+        std::time_t seconds = std::chrono::system_clock::to_time_t(slot.time);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "[%Y-%m-%d %H:%M:%S] ", &local);
+
+        buffer += stamp;
+        buffer += levelName(slot.level);
+        buffer += ": ";
+        buffer.append(slot.text, slot.length);
+        buffer += '\n';
+
+        // Освобождаем слот для следующего круга
+        slot.sequence.store(pos + CAPACITY, std::memory_order_release);
+        ++pos;
+        any = true;
+    }
+
+    dequeuePos.store(pos, std::memory_order_release);
+    return any;
+}
+
+void Logger::writerLoop() {
+    std::string buffer;
+
+    while (true) {
+        bool stopping = !running.load(std::memory_order_acquire);
+
+        buffer.clear();
+        if (drain(buffer)) {
+            // Одна запись и один flush на всю порцию сообщений
+            std::FILE* file = output.load(std::memory_order_acquire);
+            std::fwrite(buffer.data(), 1, buffer.size(), file);
+            std::fflush(file);
+            continue;
+        }
+
+        drainedCondition.notify_all();
+        if (stopping) {
+            break;
+        }
+
+        // Спим до нового сообщения или остановки, без периодического опроса
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this] {
+            return !running.load(std::memory_order_acquire) || hasPending();
+        });
+    }
+}
+
+void Logger::flush() {
+    std::size_t target = enqueuePos.load(std::memory_order_acquire);
+    wakeCondition.notify_one();
+
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    drainedCondition.wait_for(lock, std::chrono::seconds(1), [this, target] {
+        return dequeuePos.load(std::memory_order_acquire) >= target;
+    });
+}
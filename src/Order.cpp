@@ -1,34 +1,31 @@
 // src/Order.cpp
 #include "../include/Order.h"
 #include "../include/Payment.h"
-#include <iostream>
+#include "../include/Logger.h"
 #include <algorithm>
 #include <numeric>
-#include <iomanip>
 
 // РЕАЛИЗАЦИЯ КЛАССА Payment
-Payment::Payment(double amt, std::unique_ptr<PaymentStrategy> strat)
+Payment::Payment(Money amt, std::unique_ptr<PaymentStrategy> strat)
     : amount(amt), strategy(std::move(strat)), isCompleted(false) {
     transactionId = generateTransactionId();
 }
 
 bool Payment::process() {
     if (!strategy) {
-        std::cerr << "Стратегия оплаты не установлена" << std::endl;
+        LOG_ERROR("Стратегия оплаты не установлена");
         return false;
     }
 
-    std::cout << "Обработка оплаты..." << std::endl;
-    std::cout << "Сумма: $" << std::fixed << std::setprecision(2) << amount << std::endl;
-    std::cout << "Способ: " << strategy->getName() << std::endl;
-    std::cout << "ID транзакции: " << transactionId << std::endl;
+    LOG_DEBUG("Обработка оплаты " << transactionId << ": $" << amount
+              << ", способ: " << strategy->getName());
 
     isCompleted = strategy->pay(amount);
 
     if (isCompleted) {
-        std::cout << "Оплата успешно завершена" << std::endl;
+        LOG_INFO("Оплата " << transactionId << " успешно завершена");
     } else {
-        std::cout << "Ошибка оплаты" << std::endl;
+        LOG_WARNING("Ошибка оплаты " << transactionId);
     }
 
     return isCompleted;
@@ -39,26 +36,33 @@ std::string Payment::generateTransactionId() {
     std::time_t now = std::time(nullptr);
     std::string timestamp = std::to_string(now);
 
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(1000, 9999);
+    // Свой генератор у каждого потока (платежи идут из потоков сервера)
+    thread_local std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<> dis(1000, 9999);
 
     return "TRX-" + timestamp + "-" + std::to_string(dis(gen));
 }
 
 //РЕАЛИЗАЦИЯ КЛАССА Order
-Order::Order(int id, int uid, const std::string& stat, double total)
-    : orderId(id), userId(uid), status(stat), totalPrice(total) {}
-
-void Order::addItem(std::unique_ptr<OrderItem> item) {
-    items.push_back(std::move(item));
+Order::Order(int id, int uid, OrderStatus stat, Money total, const allocator_type& alloc)
+    : orderId(id), userId(uid), status(stat), totalPrice(total), items(alloc) {}
+
+Order::Order(Order&& other, const allocator_type& alloc)
+    : orderId(other.orderId), userId(other.userId), status(other.status),
+      totalPrice(other.totalPrice), items(std::move(other.items), alloc),
+      payment(std::move(other.payment)) {}
+
+OrderItem& Order::addItem(int itemId, int productId, std::string_view productName,
+                          int quantity, Money price) {
+    // Аллокатор вектора передается элементу (uses-allocator construction)
+    return items.emplace_back(itemId, productId, productName, quantity, price);
 }
 
 bool Order::removeItem(int productId) {
     // ИСПОЛЬЗОВАНИЕ STL АЛГОРИТМА find_if С ЛЯМБДОЙ
     auto it = std::find_if(items.begin(), items.end(),
-        [productId](const std::unique_ptr<OrderItem>& item) {
-            return item->getProductId() == productId;
+        [productId](const OrderItem& item) {
+            return item.getProductId() == productId;
         });
 
     if (it != items.end()) {
@@ -73,10 +77,11 @@ void Order::createPayment(std::unique_ptr<PaymentStrategy> strategy) {
 }
 
 bool Order::processPayment() {
-    if (payment) {
+    // Оплатить можно только заказ, который может перейти в completed
+    if (payment && canTransition(status, OrderStatus::Completed)) {
         bool result = payment->process();
         if (result) {
-            status = "completed";
+            status = OrderStatus::Completed;
         }
         return result;
     }
@@ -86,13 +91,13 @@ bool Order::processPayment() {
 //ЛЯМБДА-ФУНКЦИЯ для фильтрации заказов по статусу
 std::vector<std::shared_ptr<Order>> Order::filterOrdersByStatus(
     const std::vector<std::shared_ptr<Order>>& orders,
-    const std::string& targetStatus) {
+    OrderStatus targetStatus) {
 
     std::vector<std::shared_ptr<Order>> filteredOrders;
 
     //ИСПОЛЬЗОВАНИЕ STL АЛГОРИТМА copy_if С ЛЯМБДОЙ
     std::copy_if(orders.begin(), orders.end(), std::back_inserter(filteredOrders),
-        [&targetStatus](const std::shared_ptr<Order>& order) {
+        [targetStatus](const std::shared_ptr<Order>& order) {
             return order->getStatus() == targetStatus;
         });
 
@@ -100,22 +105,22 @@ std::vector<std::shared_ptr<Order>> Order::filterOrdersByStatus(
 }
 
 //ЛЯМБДА-ФУНКЦИЯ для подсчета общей суммы
-double Order::calculateTotal() const {
-    //ИСПОЛЬЗОВАНИЕ STL АЛГОРИТМА accumulate С ЛЯМБДОЙ
-    return std::accumulate(items.begin(), items.end(), 0.0,
-        [](double sum, const std::unique_ptr<OrderItem>& item) {
-            return sum + item->getTotal();
+Money Order::calculateTotal() const {
+    //ИСПОЛЬЗОВАНИЕ STL АЛГОРИТМА accumulate С ЛЯМБДОЙ (сумма в копейках - точная)
+    return std::accumulate(items.begin(), items.end(), Money(),
+        [](Money sum, const OrderItem& item) {
+            return sum + item.getTotal();
         });
 }
 
 // ЛЯМБДА-ФУНКЦИЯ для подсчета заказов по статусу
 int Order::countOrdersByStatus(
     const std::vector<std::shared_ptr<Order>>& orders,
-    const std::string& targetStatus) {
+    OrderStatus targetStatus) {
 
     // Еще один способ с использованием count_if
     return std::count_if(orders.begin(), orders.end(),
-        [&targetStatus](const std::shared_ptr<Order>& order) {
+        [targetStatus](const std::shared_ptr<Order>& order) {
             return order->getStatus() == targetStatus;
         });
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+// src/OrderColumns.cpp
+#include "../include/OrderColumns.h"
+#include "../include/DatabaseConnection.h"
+#include "../include/Logger.h"
+
+OrderColumns OrderColumns::load(DatabaseConnection<std::string>& db, std::size_t chunkSize) {
+    OrderColumns columns;
+
+    try {
+        // Оценка числа строк, чтобы выделить колонки один раз
+        auto estimate = db.query<std::int64_t>(
+            "SELECT GREATEST(reltuples, 0)::bigint FROM pg_class WHERE oid = 'orders'::regclass");
+        if (!estimate.empty()) {
+            columns.reserve(static_cast<std::size_t>(std::get<0>(estimate[0])));
+        }
+
+        // Поля разбираются прямо из буфера результата, без промежуточных строк
+        db.streamQuery(
+            "SELECT order_id, user_id, status, total_price, "
+            "EXTRACT(EPOCH FROM order_date)::bigint "
+            "FROM orders ORDER BY order_id",
+            chunkSize,
+            [&columns](const pqxx::row& row) {
+                columns.append(row[0].as<int>(),
+                               row[1].as<int>(),
+                               FieldDecoder<OrderStatus>::decode(row[2]),
+                               row[3].is_null() ? Money() : FieldDecoder<Money>::decode(row[3]),
+                               row[4].is_null() ? 0 : row[4].as<std::int64_t>());
+            });
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("Ошибка загрузки снимка заказов: " << e.what());
+        return OrderColumns();
+    }
+
+    LOG_DEBUG("Загружен снимок заказов: " << columns.size() << " строк");
+    return columns;
+}
+
+void OrderColumns::reserve(std::size_t count) {
+    orderIds.reserve(count);
+    userIds.reserve(count);
+    statuses.reserve(count);
+    totalCents.reserve(count);
+    orderDates.reserve(count);
+}
+
+void OrderColumns::append(int orderId, int userId, OrderStatus status, Money total,
+                          std::int64_t orderDate) {
+    orderIds.push_back(orderId);
+    userIds.push_back(userId);
+    statuses.push_back(static_cast<std::uint8_t>(status));
+    totalCents.push_back(total.getCents());
+    orderDates.push_back(orderDate);
+}
+
+std::size_t OrderColumns::countByStatus(OrderStatus status) const {
+    const std::uint8_t code = static_cast<std::uint8_t>(status);
+    const std::uint8_t* data = statuses.data();
+    const std::size_t n = statuses.size();
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        count += data[i] == code;
+    }
+    return count;
+}
+
+Money OrderColumns::sumByStatus(OrderStatus status) const {
+    const std::uint8_t code = static_cast<std::uint8_t>(status);
+    const std::uint8_t* codes = statuses.data();
+    const std::int64_t* totals = totalCents.data();
+    const std::size_t n = statuses.size();
+
+    // Маска вместо ветвления: -1 (все биты) для совпадения, 0 иначе
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += totals[i] & -static_cast<std::int64_t>(codes[i] == code);
+    }
+    return Money::fromCents(sum);
+}
+
+std::array<std::size_t, ORDER_STATUS_COUNT> OrderColumns::countAllStatuses() const {
+    std::array<std::size_t, ORDER_STATUS_COUNT> counts{};
+    for (std::uint8_t code : statuses) {
+        if (code < ORDER_STATUS_COUNT) {
+            ++counts[code];
+        }
+    }
+    return counts;
+}
+
+Money OrderColumns::sumInPeriod(std::int64_t from, std::int64_t to) const {
+    const std::int64_t* dates = orderDates.data();
+    const std::int64_t* totals = totalCents.data();
+    const std::size_t n = orderDates.size();
+
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::int64_t inPeriod = (dates[i] >= from) & (dates[i] < to);
+        sum += totals[i] & -inPeriod;
+    }
+    return Money::fromCents(sum);
+}
+
+std::vector<std::size_t> OrderColumns::filterByStatus(OrderStatus status) const {
+    const std::uint8_t code = static_cast<std::uint8_t>(status);
+    std::vector<std::size_t> rows;
+    rows.reserve(countByStatus(status));
+
+    for (std::size_t i = 0; i < statuses.size(); ++i) {
+        if (statuses[i] == code) {
+            rows.push_back(i);
+        }
+    }
+    return rows;
+}
@@ -0,0 +1,70 @@
+// src/OrderHistory.cpp
+#include "../include/OrderHistory.h"
+#include "../include/DatabaseConnection.h"
+#include "../include/Logger.h"
+#include <algorithm>
+
+namespace {
+
+// Одна строка на элемент заказа (заказ без элементов - одна строка с NULL).
+// orders_total и items_count нужны, чтобы выделить векторы один раз.
+const char* ORDER_HISTORY_SQL =
+    "SELECT o.order_id, o.user_id, o.status, o.total_price, "
+    "oi.order_item_id, oi.product_id, p.name, oi.quantity, oi.price, "
+    "(SELECT COALESCE(MAX(orders_count), 0) FROM user_order_stats "
+    "WHERE user_id = $1) AS orders_total, "
+    "o.items_count "
+    "FROM orders o "
+    "LEFT JOIN order_items oi ON oi.order_id = o.order_id "
+    "LEFT JOIN products p ON p.product_id = oi.product_id "
+    "WHERE o.user_id = $1 "
+    "ORDER BY o.order_date DESC, o.order_id DESC, oi.order_item_id";
+
+} // namespace
+
+OrderHistory::OrderHistory(std::size_t initialBytes)
+    : arena(initialBytes), orders(&arena) {}
+
+bool OrderHistory::load(DatabaseConnection<std::string>& db, int userId) {
+    orders.clear();
+
+    try {
+        db.streamQuery(ORDER_HISTORY_SQL, 1000, [this](const pqxx::row& row) {
+            int orderId = row[0].as<int>();
+
+            if (orders.empty() || orders.back().getOrderId() != orderId) {
+                if (orders.empty()) {
+                    orders.reserve(row[9].as<std::size_t>());
+                }
+                // Аллокатор арены передается заказу через emplace_back
+                Order& order = orders.emplace_back(
+                    orderId, row[1].as<int>(),
+                    FieldDecoder<OrderStatus>::decode(row[2]),
+                    row[3].is_null() ? Money() : FieldDecoder<Money>::decode(row[3]));
+                order.reserveItems(row[10].as<std::size_t>());
+            }
+
+            if (!row[4].is_null()) {
+                orders.back().addItem(row[4].as<int>(), row[5].as<int>(),
+                                      FieldDecoder<std::string_view>::decode(row[6]),
+                                      row[7].as<int>(),
+                                      FieldDecoder<Money>::decode(row[8]));
+            }
+        }, userId);
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("Ошибка загрузки истории заказов пользователя " << userId << ": " << e.what());
+        orders.clear();
+        return false;
+    }
+
+    return true;
+}
+
+const Order* OrderHistory::find(int orderId) const {
+    auto it = std::find_if(orders.begin(), orders.end(),
+        [orderId](const Order& order) {
+            return order.getOrderId() == orderId;
+        });
+    return it != orders.end() ? &*it : nullptr;
+}
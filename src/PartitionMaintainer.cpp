@@ -0,0 +1,48 @@
+// src/PartitionMaintainer.cpp
+#include "../include/PartitionMaintainer.h"
+#include "../include/DatabaseConnection.h"
+#include "../include/Logger.h"
+
+PartitionMaintainer::PartitionMaintainer(std::shared_ptr<DatabaseConnection<std::string>> db,
+                                         std::chrono::minutes interval)
+    : db(std::move(db)), interval(interval) {
+    worker = std::thread(&PartitionMaintainer::workLoop, this);
+}
+
+PartitionMaintainer::~PartitionMaintainer() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopCondition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void PartitionMaintainer::workLoop() {
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopping) {
+        lock.unlock();
+        runOnce();
+        lock.lock();
+
+        stopCondition.wait_for(lock, interval, [this] { return stopping; });
+    }
+}
+
+// Процедура сама берет advisory lock, поэтому параллельные серверы
+// не мешают друг другу. Ошибка не останавливает поток: следующий
+// запуск повторит обслуживание
+void PartitionMaintainer::runOnce() {
+    auto installed = db->query<bool>(
+        "SELECT EXISTS (SELECT 1 FROM pg_proc WHERE proname = 'maintainpartitions')");
+    if (installed.empty() || !std::get<0>(installed[0])) {
+        LOG_WARNING("Процедура maintainPartitions не найдена: примените sql/partitioning.sql");
+        return;
+    }
+
+    if (db->executeNonQuery("CALL maintainPartitions()")) {
+        LOG_INFO("Обслуживание секций журналов выполнено");
+    }
+}
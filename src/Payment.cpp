@@ -3,31 +3,27 @@
 //
 
 #include "../include/Payment.h"
-#include <iostream>
-#include <iomanip>
+#include "../include/Logger.h"
 
 //РЕАЛИЗАЦИЯ CreditCardPayment
 
-bool CreditCardPayment::pay(double amount) {
-    std::cout << "\n=== ОПЛАТА БАНКОВСКОЙ КАРТОЙ ===" << std::endl;
-    std::cout << "Держатель карты: " << cardHolder << std::endl;
-    std::cout << "Карта: **** **** **** " <<
-        cardNumber.substr(cardNumber.length() - 4) << std::endl;
-    std::cout << "Срок действия: " << expiryDate << std::endl;
-    std::cout << "Сумма: $" << std::fixed << std::setprecision(2) << amount << std::endl;
+bool CreditCardPayment::pay(Money amount) {
+    LOG_DEBUG("Оплата банковской картой: держатель " << cardHolder
+              << ", карта **** **** **** " << cardNumber.substr(cardNumber.length() - 4)
+              << ", срок " << expiryDate
+              << ", сумма $" << amount);
 
     // Симуляция обработки платежа
-    std::cout << "Отправка запроса в банк..." << std::endl;
-    std::cout << "Ожидание ответа..." << std::endl;
+    LOG_DEBUG("Отправка запроса в банк...");
 
     // В реальной системе здесь был бы запрос к платежному шлюзу
     bool paymentSuccess = true; // Симуляция успешного платежа
 
     if (paymentSuccess) {
-        std::cout << "Платеж одобрен банком" << std::endl;
+        LOG_INFO("Платеж одобрен банком");
         return true;
     } else {
-        std::cout << "Платеж отклонен банком" << std::endl;
+        LOG_WARNING("Платеж отклонен банком");
         return false;
     }
 }
@@ -38,23 +34,20 @@ std::string CreditCardPayment::getName() const {
 
 // РЕАЛИЗАЦИЯ WalletPayment
 
-bool WalletPayment::pay(double amount) {
-    std::cout << "\n=== ОПЛАТА ЭЛЕКТРОННЫМ КОШЕЛЬКОМ ===" << std::endl;
-    std::cout << "Тип кошелька: " << walletType << std::endl;
-    std::cout << "ID кошелька: " << walletId << std::endl;
-    std::cout << "Сумма: $" << std::fixed << std::setprecision(2) << amount << std::endl;
+bool WalletPayment::pay(Money amount) {
+    LOG_DEBUG("Оплата электронным кошельком: " << walletType << " " << walletId
+              << ", сумма $" << amount);
 
     // Симуляция обработки платежа
-    std::cout << "Подключение к платежной системе..." << std::endl;
-    std::cout << "Списание средств с кошелька..." << std::endl;
+    LOG_DEBUG("Списание средств с кошелька...");
 
     bool paymentSuccess = true; // Симуляция успешного платежа
 
     if (paymentSuccess) {
-        std::cout << "Средства успешно списаны" << std::endl;
+        LOG_INFO("Средства успешно списаны");
         return true;
     } else {
-        std::cout << "Недостаточно средств на кошельке" << std::endl;
+        LOG_WARNING("Недостаточно средств на кошельке");
         return false;
     }
 }
@@ -64,24 +57,20 @@ std::string WalletPayment::getName() const {
 }
 
 // РЕАЛИЗАЦИЯ SBPPayment
-bool SBPPayment::pay(double amount) {
-    std::cout << "\n=== ОПЛАТА ЧЕРЕЗ СБП ===" << std::endl;
-    std::cout << "Банк: " << bankName << std::endl;
-    std::cout << "Номер телефона: " << phoneNumber << std::endl;
-    std::cout << "Сумма: $" << std::fixed << std::setprecision(2) << amount << std::endl;
+bool SBPPayment::pay(Money amount) {
+    LOG_DEBUG("Оплата через СБП: банк " << bankName << ", телефон " << phoneNumber
+              << ", сумма $" << amount);
 
     // Симуляция обработки платежа
-    std::cout << "Генерация QR-кода..." << std::endl;
-    std::cout << "Ожидание подтверждения платежа..." << std::endl;
-    std::cout << "Проверка статуса в банке..." << std::endl;
+    LOG_DEBUG("Ожидание подтверждения платежа...");
 
     bool paymentSuccess = true; // Симуляция успешного платежа
 
     if (paymentSuccess) {
-        std::cout << "Платеж подтвержден через СБП" << std::endl;
+        LOG_INFO("Платеж подтвержден через СБП");
         return true;
     } else {
-        std::cout << "Платеж не подтвержден" << std::endl;
+        LOG_WARNING("Платеж не подтвержден");
         return false;
     }
 }
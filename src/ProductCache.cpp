@@ -0,0 +1,222 @@
+// src/ProductCache.cpp
+#include "../include/ProductCache.h"
+#include "../include/DatabaseConnection.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    // Получатель уведомлений product_changes: в payload - product_id
+    class ChangeReceiver : public pqxx::notification_receiver {
+    private:
+        ProductCache& cache;
+
+    public:
+        ChangeReceiver(pqxx::connection& conn, ProductCache& cache)
+            : pqxx::notification_receiver(conn, ProductCache::CHANNEL), cache(cache) {}
+
+        void operator()(const std::string& payload, int) override {
+            try {
+                cache.invalidate(std::stoi(payload));
+            } catch (const std::exception&) {
+                // Непонятный payload - сбрасываем весь кэш
+                cache.invalidateAll();
+            }
+        }
+    };
+
+    // Строка product_id, name, price, stock_quantity
+    using ProductRows = TypedResult<int, std::string, Money, int>;
+
+    CachedProduct toProduct(std::tuple<int, std::string, Money, int> row) {
+        auto& [id, name, price, stock] = row;
+        return CachedProduct{id, std::move(name), price, stock};
+    }
+}
+
+ProductCache::ProductCache(std::shared_ptr<DatabaseConnection<std::string>> db)
+    : db(std::move(db)) {
+    listener = std::thread(&ProductCache::listenLoop, this);
+}
+
+ProductCache::~ProductCache() {
+    stopping.store(true, std::memory_order_release);
+    if (listener.joinable()) {
+        listener.join();
+    }
+}
+
+std::optional<CachedProduct> ProductCache::get(int productId) {
+    bool cacheable = isListening();
+    std::uint64_t seenGeneration = 0;
+
+    if (cacheable) {
+        std::shared_lock<std::shared_mutex> lock(cacheMutex);
+        if (!staleIds.count(productId)) {
+            auto it = products.find(productId);
+            if (it != products.end()) {
+                return it->second;
+            }
+            // Каталог загружен целиком - такого товара нет
+            if (catalogLoaded) {
+                return std::nullopt;
+            }
+        }
+        seenGeneration = generation;
+    }
+
+    ProductRows result = db->queryPrepared<int, std::string, Money, int>("product_by_id", productId);
+    if (result.empty()) {
+        return std::nullopt;
+    }
+
+    CachedProduct product = toProduct(result[0]);
+
+    // Кэшируем, только если за время запроса не было инвалидаций
+    if (cacheable) {
+        std::unique_lock<std::shared_mutex> lock(cacheMutex);
+        if (generation == seenGeneration) {
+            products[productId] = product;
+            staleIds.erase(productId);
+        }
+    }
+    return product;
+}
+
+std::vector<CachedProduct> ProductCache::getAvailable() {
+    if (isListening()) {
+        // Несколько попыток: параллельная инвалидация отменяет обновление
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            {
+                std::shared_lock<std::shared_mutex> lock(cacheMutex);
+                if (catalogLoaded && staleIds.empty()) {
+                    std::vector<CachedProduct> available;
+                    for (const auto& entry : products) {
+                        if (entry.second.stockQuantity > 0) {
+                            available.push_back(entry.second);
+                        }
+                    }
+                    std::sort(available.begin(), available.end(),
+                              [](const CachedProduct& a, const CachedProduct& b) {
+                                  return a.productId < b.productId;
+                              });
+                    return available;
+                }
+            }
+
+            if (!refreshCatalog()) {
+                break;
+            }
+        }
+    }
+
+    return loadAvailable();
+}
+
+// Загрузка всего каталога или перечитывание только устаревших товаров.
+// false - обновление не применено (ошибка или параллельная инвалидация)
+bool ProductCache::refreshCatalog() {
+    std::uint64_t seenGeneration;
+    bool full;
+    std::vector<int> ids;
+    {
+        std::shared_lock<std::shared_mutex> lock(cacheMutex);
+        seenGeneration = generation;
+        full = !catalogLoaded;
+        ids.assign(staleIds.begin(), staleIds.end());
+    }
+
+    // Ошибка запроса не должна выглядеть как "товаров нет": иначе частичное
+    // обновление удалило бы устаревшие товары из кэша
+    auto fetched = full
+        ? db->tryQueryPrepared<int, std::string, Money, int>("products_all")
+        : db->tryQueryPrepared<int, std::string, Money, int>("products_by_ids", ids);
+
+    if (!fetched || (full && fetched->empty())) {
+        return false;
+    }
+    ProductRows& result = *fetched;
+
+    std::unique_lock<std::shared_mutex> lock(cacheMutex);
+    if (generation != seenGeneration) {
+        return false;
+    }
+
+    if (full) {
+        products.clear();
+        products.reserve(result.size());
+    } else {
+        // Удаленные товары не вернутся запросом
+        for (int id : ids) {
+            products.erase(id);
+        }
+    }
+    for (auto row : result) {
+        CachedProduct product = toProduct(std::move(row));
+        products[product.productId] = std::move(product);
+    }
+
+    catalogLoaded = true;
+    staleIds.clear();
+    LOG_DEBUG("Кэш товаров обновлен: " << (full ? "весь каталог, " : "изменения, ")
+              << result.size() << " товаров");
+    return true;
+}
+
+// Запрос в обход кэша
+std::vector<CachedProduct> ProductCache::loadAvailable() {
+    std::vector<CachedProduct> available;
+    ProductRows result = db->queryPrepared<int, std::string, Money, int>("products_available");
+    available.reserve(result.size());
+    for (auto row : result) {
+        available.push_back(toProduct(std::move(row)));
+    }
+    return available;
+}
+
+void ProductCache::invalidate(int productId) {
+    std::unique_lock<std::shared_mutex> lock(cacheMutex);
+    ++generation;
+    staleIds.insert(productId);
+}
+
+void ProductCache::invalidateAll() {
+    std::unique_lock<std::shared_mutex> lock(cacheMutex);
+    ++generation;
+    products.clear();
+    staleIds.clear();
+    catalogLoaded = false;
+}
+
+// ПОТОК ПОДПИСКИ
+// Держит отдельное соединение с LISTEN и при обрыве переподключается.
+// Пока подписки нет, уведомления могут теряться, поэтому кэш сбрасывается
+// и не используется.
+void ProductCache::listenLoop() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        try {
+            auto conn = db->openDedicatedConnection();
+            ChangeReceiver receiver(*conn, *this);
+
+            invalidateAll();
+            listening.store(true, std::memory_order_release);
+            LOG_INFO("Кэш товаров подписан на " << CHANNEL);
+
+            // Ждем уведомления не дольше секунды, чтобы заметить остановку
+            while (!stopping.load(std::memory_order_acquire)) {
+                conn->await_notification(1, 0);
+            }
+
+        } catch (const std::exception& e) {
+            LOG_WARNING("Подписка кэша товаров прервана: " << e.what());
+        }
+
+        listening.store(false, std::memory_order_release);
+        invalidateAll();
+
+        // Пауза перед переподключением
+        for (int i = 0; i < 10 && !stopping.load(std::memory_order_acquire); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
@@ -0,0 +1,69 @@
+// src/RepriceWorker.cpp
+#include "../include/RepriceWorker.h"
+#include "../include/DatabaseConnection.h"
+#include "../include/Logger.h"
+
+namespace {
+    // Получатель уведомлений reprice_jobs (payload - product_id, не нужен)
+    class JobReceiver : public pqxx::notification_receiver {
+    private:
+        RepriceWorker& worker;
+
+    public:
+        JobReceiver(pqxx::connection& conn, RepriceWorker& worker)
+            : pqxx::notification_receiver(conn, RepriceWorker::CHANNEL), worker(worker) {}
+
+        void operator()(const std::string&, int) override {
+            worker.wake();
+        }
+    };
+}
+
+RepriceWorker::RepriceWorker(std::shared_ptr<DatabaseConnection<std::string>> db,
+                             std::chrono::seconds pollInterval)
+    : db(std::move(db)), pollInterval(pollInterval) {
+    worker = std::thread(&RepriceWorker::workLoop, this);
+}
+
+RepriceWorker::~RepriceWorker() {
+    stopping.store(true, std::memory_order_release);
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+// ПОТОК ИСПОЛНИТЕЛЯ
+// При ошибке соединение закрывается (вместе с ним снимается advisory lock
+// процедуры) и открывается заново.
+void RepriceWorker::workLoop() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        try {
+            auto conn = db->openDedicatedConnection();
+            JobReceiver receiver(*conn, *this);
+            auto lastRun = std::chrono::steady_clock::now();
+
+            while (!stopping.load(std::memory_order_acquire)) {
+                auto now = std::chrono::steady_clock::now();
+                if (wakeRequested.exchange(false, std::memory_order_acq_rel) ||
+                    now - lastRun >= pollInterval) {
+                    // Процедура сама фиксирует каждую порцию - вызываем вне транзакции
+                    pqxx::nontransaction ntx(*conn);
+                    ntx.exec("CALL processRepriceJobs()");
+                    lastRun = now;
+                }
+
+                // Ждем уведомления не дольше секунды, чтобы заметить остановку
+                conn->await_notification(1, 0);
+            }
+
+        } catch (const std::exception& e) {
+            LOG_WARNING("Исполнитель заданий пересчета цен прерван: " << e.what());
+            wakeRequested.store(true, std::memory_order_release);
+        }
+
+        // Пауза перед переподключением
+        for (int i = 0; i < 10 && !stopping.load(std::memory_order_acquire); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
@@ -0,0 +1,890 @@
+// src/StoreServer.cpp
+#include "../include/StoreServer.h"
+#include "../include/DatabaseConnection.h"
+#include "../include/Logger.h"
+#include "../include/User.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <optional>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // macOS: SIGPIPE игнорируется в server_main.cpp
+#endif
+
+// СЕССИЯ КЛИЕНТА
+// Поля под mutex делят поток ввода-вывода и рабочий поток. user трогает
+// только рабочий поток, выполняющий запрос сессии (busy == true).
+struct ServerSession {
+    int fd = -1;
+    std::shared_ptr<User> user;
+
+    std::mutex mutex;
+    std::string input;                  // Непрочитанный остаток строки
+    std::deque<std::string> pending;    // Полные строки запросов
+    std::string output;                 // Неотправленные ответы
+    bool busy = false;                  // Сессия в очереди или выполняется
+    bool readOpen = true;               // Клиент еще может прислать запросы
+    bool closeRequested = false;        // QUIT или ошибка протокола
+    bool peerGone = false;              // Писать в сокет больше нельзя
+    int failedLogins = 0;               // Только рабочий поток
+};
+
+namespace {
+    // Сколько запросов сессии принимать вперед, пока не выполнены прежние
+    constexpr std::size_t MAX_PENDING_REQUESTS = 32;
+
+    // Сколько неотправленного ответа держать, прежде чем перестать читать
+    constexpr std::size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+
+    // После стольких неудачных LOGIN сессия закрывается
+    constexpr int MAX_LOGIN_ATTEMPTS = 3;
+
+    bool setNonBlocking(int fd) {
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    // Отправка накопленного ответа, сколько примет сокет (вызывать под mutex)
+    void flushOutput(ServerSession& session) {
+        std::size_t sent = 0;
+        while (sent < session.output.size() && !session.peerGone) {
+            ssize_t n = ::send(session.fd, session.output.data() + sent,
+                               session.output.size() - sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += static_cast<std::size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                session.peerGone = true;
+                session.readOpen = false;
+            }
+        }
+
+        if (session.peerGone) {
+            session.output.clear();
+        } else {
+            session.output.erase(0, sent);
+        }
+    }
+
+    //  ОТВЕТ
+    struct Response {
+        std::string error;                          // Не пусто - ERR
+        std::vector<std::vector<std::string>> rows;
+        std::optional<PageCursor> next;
+
+        static Response ok() { return Response(); }
+
+        static Response fail(std::string message) {
+            Response response;
+            response.error = std::move(message);
+            return response;
+        }
+
+        static Response row(std::vector<std::string> fields) {
+            Response response;
+            response.rows.push_back(std::move(fields));
+            return response;
+        }
+
+        static Response table(std::vector<std::vector<std::string>> rows) {
+            Response response;
+            response.rows = std::move(rows);
+            return response;
+        }
+
+        static Response page(Page page) {
+            Response response;
+            response.rows = std::move(page.rows);
+            response.next = std::move(page.next);
+            return response;
+        }
+
+        // Результат операции: при отказе - причина из метода, а если
+        // ее нет - общий текст команды
+        static Response result(const ActionResult& result, const char* fallback) {
+            if (result) {
+                return ok();
+            }
+            return fail(result.message.empty() ? fallback : result.message);
+        }
+    };
+
+    // Экранирование поля как в COPY: строка ответа не рвется данными
+    void appendField(std::string& out, std::string_view field) {
+        for (char c : field) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                default: out += c;
+            }
+        }
+    }
+
+    // Курсор одним словом: пробел в дате заменяется на 'T' (ISO 8601,
+    // PostgreSQL принимает обе формы), id - после последней запятой
+    std::string formatCursor(const PageCursor& cursor) {
+        std::string token = cursor.lastTime;
+        for (char& c : token) {
+            if (c == ' ') {
+                c = 'T';
+            }
+        }
+        return token + "," + std::to_string(cursor.lastId);
+    }
+
+    std::optional<int> parseInt(std::string_view text) {
+        int value = 0;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc() || end != text.data() + text.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::optional<PageCursor> parseCursor(std::string_view token) {
+        auto comma = token.rfind(',');
+        if (comma == std::string_view::npos || comma == 0) {
+            return std::nullopt;
+        }
+        auto id = parseInt(token.substr(comma + 1));
+        if (!id) {
+            return std::nullopt;
+        }
+        return PageCursor{std::string(token.substr(0, comma)), *id};
+    }
+
+    std::string render(const Response& response) {
+        std::string out;
+        if (!response.error.empty()) {
+            out = "ERR ";
+            appendField(out, response.error);
+            out += '\n';
+            return out;
+        }
+
+        out = "OK " + std::to_string(response.rows.size());
+        if (response.next) {
+            out += ' ';
+            out += formatCursor(*response.next);
+        }
+        out += '\n';
+
+        for (const auto& row : response.rows) {
+            for (std::size_t i = 0; i < row.size(); ++i) {
+                if (i > 0) {
+                    out += '\t';
+                }
+                appendField(out, row[i]);
+            }
+            out += '\n';
+        }
+        return out;
+    }
+
+    //  РАЗБОР ЗАПРОСА
+    using Args = std::vector<std::string_view>;
+
+    Args splitWords(std::string_view line) {
+        Args words;
+        std::size_t pos = 0;
+        while (pos < line.size()) {
+            auto start = line.find_first_not_of(" \t", pos);
+            if (start == std::string_view::npos) {
+                break;
+            }
+            auto end = line.find_first_of(" \t", start);
+            if (end == std::string_view::npos) {
+                end = line.size();
+            }
+            words.push_back(line.substr(start, end - start));
+            pos = end;
+        }
+        return words;
+    }
+
+    // Аргументы страницы: [<размер> [<курсор>]], начиная с args[first]
+    bool parsePageArgs(const Args& args, std::size_t first, std::size_t defaultSize,
+                       std::size_t& pageSize, std::optional<PageCursor>& after) {
+        pageSize = defaultSize;
+        if (args.size() > first) {
+            auto size = parseInt(args[first]);
+            if (!size || *size <= 0) {
+                return false;
+            }
+            // Верхнюю границу применяют методы списков (MAX_PAGE_SIZE)
+            pageSize = static_cast<std::size_t>(*size);
+        }
+        if (args.size() > first + 1) {
+            after = parseCursor(args[first + 1]);
+            if (!after) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //  КОМАНДЫ
+    // args[0] - имя команды. role - требуемая роль (nullptr - любая после входа)
+    struct Command {
+        const char* role;
+        std::size_t minArgs;
+        std::size_t maxArgs;
+        const char* usage;
+        Response (*run)(User& user, const Args& args);
+    };
+
+    const std::unordered_map<std::string_view, Command>& commandTable() {
+        //ИСПОЛЬЗОВАНИЕ ЛЯМБДА-ФУНКЦИЙ без захвата как обработчиков команд
+        static const std::unordered_map<std::string_view, Command> commands = {
+            // Общие для всех ролей
+            {"PRODUCTS", {nullptr, 1, 1, "PRODUCTS",
+                [](User& user, const Args&) {
+                    return Response::table(user.getAvailableProducts());
+                }}},
+            {"STATUS", {nullptr, 2, 2, "STATUS <order_id>",
+                [](User& user, const Args& args) {
+                    auto orderId = parseInt(args[1]);
+                    if (!orderId) {
+                        return Response::fail("Некорректный ID заказа");
+                    }
+                    return Response::row({user.viewOrderStatus(*orderId)});
+                }}},
+            {"CANCEL", {nullptr, 2, 2, "CANCEL <order_id>",
+                [](User& user, const Args& args) {
+                    auto orderId = parseInt(args[1]);
+                    if (!orderId) {
+                        return Response::fail("Некорректный ID заказа");
+                    }
+                    return Response::result(user.cancelOrder(*orderId), "Заказ не отменен");
+                }}},
+
+            // Покупатель
+            {"ORDER", {"customer", 2, 101, "ORDER <product_id>:<quantity> ...",
+                [](User& user, const Args& args) {
+                    std::vector<std::pair<int, int>> cart;
+                    for (std::size_t i = 1; i < args.size(); ++i) {
+                        auto colon = args[i].find(':');
+                        auto productId = parseInt(args[i].substr(0, colon));
+                        auto quantity = colon == std::string_view::npos
+                            ? std::optional<int>() : parseInt(args[i].substr(colon + 1));
+                        if (!productId || !quantity || *quantity <= 0) {
+                            return Response::fail("Некорректная позиция: " + std::string(args[i]));
+                        }
+                        cart.emplace_back(*productId, *quantity);
+                    }
+
+                    auto results = dynamic_cast<Customer&>(user).createOrders({cart}, 1);
+                    if (results.empty() || !results[0].orderId) {
+                        return Response::fail(results.empty() || results[0].error.empty()
+                                                  ? "Заказ не создан" : results[0].error);
+                    }
+                    return Response::row({std::to_string(*results[0].orderId)});
+                }}},
+            {"MY_ORDERS", {"customer", 1, 3, "MY_ORDERS [<page_size> [<cursor>]]",
+                [](User& user, const Args& args) {
+                    std::size_t pageSize;
+                    std::optional<PageCursor> after;
+                    if (!parsePageArgs(args, 1, 20, pageSize, after)) {
+                        return Response::fail("Некорректный размер страницы или курсор");
+                    }
+                    return Response::page(
+                        dynamic_cast<Customer&>(user).getMyOrderHistory(pageSize, after));
+                }}},
+            {"ADD", {"customer", 4, 4, "ADD <order_id> <product_id> <quantity>",
+                [](User& user, const Args& args) {
+                    auto orderId = parseInt(args[1]);
+                    auto productId = parseInt(args[2]);
+                    auto quantity = parseInt(args[3]);
+                    if (!orderId || !productId || !quantity || *quantity <= 0) {
+                        return Response::fail("Некорректные аргументы");
+                    }
+                    return Response::result(
+                        dynamic_cast<Customer&>(user).addToOrder(*orderId, *productId, *quantity),
+                        "Товар не добавлен");
+                }}},
+            {"REMOVE", {"customer", 2, 2, "REMOVE <order_item_id>",
+                [](User& user, const Args& args) {
+                    auto itemId = parseInt(args[1]);
+                    if (!itemId) {
+                        return Response::fail("Некорректный ID позиции");
+                    }
+                    return Response::result(
+                        dynamic_cast<Customer&>(user).removeFromOrder(*itemId),
+                        "Товар не удален");
+                }}},
+            {"PAY", {"customer", 3, 3, "PAY <order_id> <method>",
+                [](User& user, const Args& args) {
+                    auto orderId = parseInt(args[1]);
+                    if (!orderId) {
+                        return Response::fail("Некорректный ID заказа");
+                    }
+                    return Response::result(
+                        dynamic_cast<Customer&>(user).makePayment(*orderId, std::string(args[2])),
+                        "Оплата не проведена");
+                }}},
+            {"RETURN", {"customer", 2, 2, "RETURN <order_id>",
+                [](User& user, const Args& args) {
+                    auto orderId = parseInt(args[1]);
+                    if (!orderId) {
+                        return Response::fail("Некорректный ID заказа");
+                    }
+                    return Response::result(
+                        dynamic_cast<Customer&>(user).returnOrder(*orderId),
+                        "Возврат не оформлен");
+                }}},
+
+            // Менеджер
+            {"PENDING", {"manager", 1, 3, "PENDING [<page_size> [<cursor>]]",
+                [](User& user, const Args& args) {
+                    std::size_t pageSize;
+                    std::optional<PageCursor> after;
+                    if (!parsePageArgs(args, 1, 50, pageSize, after)) {
+                        return Response::fail("Некорректный размер страницы или курсор");
+                    }
+                    return Response::page(
+                        dynamic_cast<Manager&>(user).getPendingOrders(pageSize, after));
+                }}},
+            {"APPROVE", {"manager", 2, 2, "APPROVE <order_id>",
+                [](User& user, const Args& args) {
+                    auto orderId = parseInt(args[1]);
+                    if (!orderId) {
+                        return Response::fail("Некорректный ID заказа");
+                    }
+                    return Response::result(
+                        dynamic_cast<Manager&>(user).approveOrder(*orderId),
+                        "Заказ не утвержден");
+                }}},
+            {"STOCK", {"manager", 3, 3, "STOCK <product_id> <quantity>",
+                [](User& user, const Args& args) {
+                    auto productId = parseInt(args[1]);
+                    auto quantity = parseInt(args[2]);
+                    if (!productId || !quantity || *quantity < 0) {
+                        return Response::fail("Некорректные аргументы");
+                    }
+                    return Response::result(
+                        dynamic_cast<Manager&>(user).updateStock(*productId, *quantity),
+                        "Остаток не обновлен");
+                }}},
+            {"APPROVED", {"manager", 1, 1, "APPROVED",
+                [](User& user, const Args&) {
+                    return Response::table(dynamic_cast<Manager&>(user).getApprovedOrdersHistory());
+                }}},
+
+            // Администратор
+            {"ORDERS", {"admin", 1, 3, "ORDERS [<page_size> [<cursor>]]",
+                [](User& user, const Args& args) {
+                    std::size_t pageSize;
+                    std::optional<PageCursor> after;
+                    if (!parsePageArgs(args, 1, 50, pageSize, after)) {
+                        return Response::fail("Некорректный размер страницы или курсор");
+                    }
+                    return Response::page(
+                        dynamic_cast<Admin&>(user).viewAllOrders(pageSize, after));
+                }}},
+            {"AUDIT", {"admin", 1, 4, "AUDIT [<days> [<page_size> [<cursor>]]]",
+                [](User& user, const Args& args) {
+                    auto days = args.size() > 1 ? parseInt(args[1]) : std::optional<int>(30);
+                    std::size_t pageSize;
+                    std::optional<PageCursor> after;
+                    if (!days || *days <= 0 || !parsePageArgs(args, 2, 100, pageSize, after)) {
+                        return Response::fail("Некорректные аргументы");
+                    }
+                    return Response::page(
+                        dynamic_cast<Admin&>(user).getAuditLog(*days, pageSize, after));
+                }}},
+            {"AUDIT_BY_USER", {"admin", 2, 2, "AUDIT_BY_USER <user_id>",
+                [](User& user, const Args& args) {
+                    auto userId = parseInt(args[1]);
+                    if (!userId) {
+                        return Response::fail("Некорректный ID пользователя");
+                    }
+                    return Response::table(dynamic_cast<Admin&>(user).getAuditLogByUser(*userId));
+                }}},
+            {"SET_STATUS", {"admin", 3, 3, "SET_STATUS <order_id> <status>",
+                [](User& user, const Args& args) {
+                    auto orderId = parseInt(args[1]);
+                    auto status = parseOrderStatus(args[2]);
+                    if (!orderId || !status) {
+                        return Response::fail("Некорректный ID заказа или статус");
+                    }
+                    return Response::result(
+                        dynamic_cast<Admin&>(user).updateOrderStatus(*orderId, *status),
+                        "Статус не изменен");
+                }}},
+            // История статусов любого заказа (как в консоли - только администратору:
+            // getOrderStatusHistory не проверяет владельца)
+            {"STATUS_HISTORY", {"admin", 2, 2, "STATUS_HISTORY <order_id>",
+                [](User& user, const Args& args) {
+                    auto orderId = parseInt(args[1]);
+                    if (!orderId) {
+                        return Response::fail("Некорректный ID заказа");
+                    }
+                    return Response::table(user.getOrderStatusHistory(*orderId));
+                }}},
+            {"REPRICE_JOBS", {"admin", 1, 1, "REPRICE_JOBS",
+                [](User& user, const Args&) {
+                    return Response::table(dynamic_cast<Admin&>(user).getRepriceJobs());
+                }}},
+        };
+        return commands;
+    }
+}
+
+StoreServer::StoreServer(std::shared_ptr<DatabaseConnection<std::string>> db,
+                         std::shared_ptr<AuditQueue> auditQueue,
+                         std::shared_ptr<ProductCache> productCache,
+                         ServerOptions options)
+    : db(std::move(db)), auditQueue(std::move(auditQueue)),
+      productCache(std::move(productCache)), options(std::move(options)) {
+    this->options.workers = std::max<std::size_t>(1, this->options.workers);
+
+    // Пароль сверяется в БД с bcrypt-хешем (pgcrypto, см. setUserPassword
+    // в sql/database_setup.sql); пользователь без пароля войти не может.
+    // Хеш другого вида не передается в crypt(): CASE гарантирует порядок
+    // проверок, и слабый алгоритм не выбирается по "соли" из таблицы
+    this->db->registerStatement("server_user_login",
+        "SELECT name, email, role, loyalty_level FROM users "
+        "WHERE user_id = $1 "
+        "AND CASE WHEN password_hash LIKE '$2_$%' "
+        "THEN password_hash = crypt($2, password_hash) ELSE FALSE END");
+}
+
+StoreServer::~StoreServer() {
+    stop();
+}
+
+bool StoreServer::start() {
+    if (ioThread.joinable()) {
+        return true;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (::inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+        LOG_ERROR("Некорректный адрес сервера: " << options.host);
+        return false;
+    }
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    if (listenFd < 0 ||
+        ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0 ||
+        !setNonBlocking(listenFd) ||
+        ::pipe(wakePipe) != 0 ||
+        !setNonBlocking(wakePipe[0]) || !setNonBlocking(wakePipe[1])) {
+        LOG_ERROR("Не удалось запустить сервер на " << options.host << ":" << options.port
+                  << ": " << std::strerror(errno));
+        stop();
+        return false;
+    }
+
+    stopping.store(false, std::memory_order_release);
+    for (std::size_t i = 0; i < options.workers; ++i) {
+        workers.emplace_back(&StoreServer::workerLoop, this);
+    }
+    ioThread = std::thread(&StoreServer::ioLoop, this);
+
+    if (address.sin_addr.s_addr != htonl(INADDR_LOOPBACK)) {
+        LOG_WARNING("Сервер доступен не только локально, а пароли передаются открытым "
+                    "текстом: используйте TLS-туннель (stunnel, ssh -L)");
+    }
+    LOG_INFO("Сервер слушает " << options.host << ":" << options.port
+             << ", рабочих потоков: " << options.workers);
+    return true;
+}
+
+void StoreServer::stop() {
+    stopping.store(true, std::memory_order_release);
+    wakeIo();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        readyQueue.clear();
+    }
+    queueCondition.notify_all();
+
+    if (ioThread.joinable()) {
+        ioThread.join();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    for (auto& [fd, session] : sessions) {
+        ::close(fd);
+    }
+    sessions.clear();
+    openSessions.store(0, std::memory_order_relaxed);
+
+    for (int* fd : {&listenFd, &wakePipe[0], &wakePipe[1]}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+std::size_t StoreServer::sessionCount() const {
+    return openSessions.load(std::memory_order_relaxed);
+}
+
+//  ПОТОК ВВОДА-ВЫВОДА
+void StoreServer::ioLoop() {
+    std::vector<pollfd> fds;
+    std::vector<std::shared_ptr<ServerSession>> polled;
+
+    while (!stopping.load(std::memory_order_acquire)) {
+        // Набор дескрипторов собирается заново: события сессии зависят
+        // от ее очереди запросов и неотправленного ответа
+        fds.clear();
+        polled.clear();
+        fds.push_back({listenFd, POLLIN, 0});
+        fds.push_back({wakePipe[0], POLLIN, 0});
+
+        for (auto& [fd, session] : sessions) {
+            short events = 0;
+            {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                // Оборванное соединение ждет только закрытия: poll сообщал бы
+                // о нем на каждом проходе
+                if (session->peerGone) {
+                    continue;
+                }
+                if (session->readOpen && !session->closeRequested &&
+                    session->pending.size() < MAX_PENDING_REQUESTS &&
+                    session->output.size() < MAX_PENDING_OUTPUT) {
+                    events |= POLLIN;
+                }
+                if (!session->output.empty()) {
+                    events |= POLLOUT;
+                }
+            }
+            fds.push_back({fd, events, 0});
+            polled.push_back(session);
+        }
+
+        if (::poll(fds.data(), fds.size(), 1000) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Ошибка poll: " << std::strerror(errno));
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char buffer[256];
+            while (::read(wakePipe[0], buffer, sizeof(buffer)) > 0) {}
+        }
+        if (fds[0].revents & POLLIN) {
+            acceptClients();
+        }
+
+        for (std::size_t i = 0; i < polled.size(); ++i) {
+            short revents = fds[i + 2].revents;
+            const auto& session = polled[i];
+
+            if (revents & POLLIN) {
+                readFromClient(session);
+            } else if (revents & (POLLHUP | POLLERR)) {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                session->readOpen = false;
+                session->peerGone = true;
+                session->output.clear();
+            }
+            if (revents & POLLOUT) {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                flushOutput(*session);
+            }
+        }
+
+        closeFinishedSessions();
+    }
+}
+
+void StoreServer::acceptClients() {
+    while (true) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG_WARNING("Ошибка accept: " << std::strerror(errno));
+            }
+            return;
+        }
+
+        if (sessions.size() >= options.maxSessions || !setNonBlocking(fd)) {
+            LOG_WARNING("Соединение отклонено: открыто сессий " << sessions.size());
+            ::close(fd);
+            continue;
+        }
+
+        auto session = std::make_shared<ServerSession>();
+        session->fd = fd;
+        sessions.emplace(fd, std::move(session));
+        openSessions.store(sessions.size(), std::memory_order_relaxed);
+    }
+}
+
+void StoreServer::readFromClient(const std::shared_ptr<ServerSession>& session) {
+    char buffer[4096];
+    bool hasWork = false;
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (!session->readOpen) {
+            return;
+        }
+
+        ssize_t n = ::recv(session->fd, buffer, sizeof(buffer), 0);
+        if (n == 0) {
+            session->readOpen = false;
+        } else if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                session->readOpen = false;
+                session->peerGone = true;
+            }
+        } else {
+            session->input.append(buffer, static_cast<std::size_t>(n));
+
+            // Разбиваем на строки; '\r' от telnet-подобных клиентов отбрасывается
+            std::size_t start = 0;
+            std::size_t newline;
+            while ((newline = session->input.find('\n', start)) != std::string::npos) {
+                std::size_t end = newline;
+                if (end > start && session->input[end - 1] == '\r') {
+                    --end;
+                }
+                if (end > start) {
+                    session->pending.emplace_back(session->input, start, end - start);
+                }
+                start = newline + 1;
+            }
+            session->input.erase(0, start);
+
+            if (session->input.size() > options.maxLineLength) {
+                session->input.clear();
+                session->output += render(Response::fail("Слишком длинная строка запроса"));
+                session->readOpen = false;
+                session->closeRequested = true;
+                flushOutput(*session);
+            }
+        }
+
+        if (!session->busy && !session->pending.empty()) {
+            session->busy = true;
+            hasWork = true;
+        }
+    }
+
+    if (hasWork) {
+        schedule(session);
+    }
+}
+
+// Сессия закрывается, когда запросов больше не будет, выполненные
+// запросы отвечены и рабочий поток ее не держит
+void StoreServer::closeFinishedSessions() {
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        auto& session = it->second;
+        bool finished;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            bool noMoreRequests = !session->readOpen || session->closeRequested;
+            bool drained = session->pending.empty() || session->closeRequested ||
+                           session->peerGone;
+            finished = noMoreRequests && drained && !session->busy &&
+                       (session->output.empty() || session->peerGone);
+            if (finished) {
+                ::close(session->fd);
+                session->fd = -1;
+            }
+        }
+
+        if (finished) {
+            it = sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    openSessions.store(sessions.size(), std::memory_order_relaxed);
+}
+
+void StoreServer::wakeIo() {
+    if (wakePipe[1] >= 0) {
+        char byte = 1;
+        // Полный канал - поток и так будет разбужен
+        [[maybe_unused]] ssize_t n = ::write(wakePipe[1], &byte, 1);
+    }
+}
+
+//  РАБОЧИЕ ПОТОКИ
+void StoreServer::schedule(std::shared_ptr<ServerSession> session) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        readyQueue.push_back(std::move(session));
+    }
+    queueCondition.notify_one();
+}
+
+// Поток выполняет один запрос сессии и возвращает ее в конец очереди,
+// если есть еще: длинная серия запросов одного клиента не задерживает других
+void StoreServer::workerLoop() {
+    while (true) {
+        std::shared_ptr<ServerSession> session;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this] {
+                return stopping.load(std::memory_order_acquire) || !readyQueue.empty();
+            });
+            if (stopping.load(std::memory_order_acquire)) {
+                return;
+            }
+            session = std::move(readyQueue.front());
+            readyQueue.pop_front();
+        }
+
+        std::string line;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (session->closeRequested || session->peerGone) {
+                session->pending.clear();
+            }
+            if (session->pending.empty()) {
+                session->busy = false;
+                wakeIo();
+                continue;
+            }
+            line = std::move(session->pending.front());
+            session->pending.pop_front();
+        }
+
+        std::string reply = execute(*session, line);
+
+        bool more;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->output += reply;
+            flushOutput(*session);
+            more = !session->pending.empty() && !session->closeRequested && !session->peerGone;
+            session->busy = more;
+        }
+
+        if (more) {
+            schedule(session);
+        }
+        // Поток ввода-вывода дождется остатка ответа или закроет сессию
+        wakeIo();
+    }
+}
+
+// ВЫПОЛНЕНИЕ ЗАПРОСА
+std::string StoreServer::execute(ServerSession& session, std::string_view line) {
+    Args args = splitWords(line);
+    if (args.empty()) {
+        return render(Response::fail("Пустой запрос"));
+    }
+
+    const std::string_view name = args[0];
+    try {
+        if (name == "PING") {
+            return render(Response::ok());
+        }
+        if (name == "QUIT") {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            session.closeRequested = true;
+            return render(Response::ok());
+        }
+        if (name == "LOGIN") {
+            // Пароль - остаток строки после user_id (может содержать пробелы)
+            auto userId = args.size() >= 3 ? parseInt(args[1]) : std::nullopt;
+            if (!userId) {
+                return render(Response::fail("Использование: LOGIN <user_id> <пароль>"));
+            }
+            std::size_t passwordStart = static_cast<std::size_t>(args[2].data() - line.data());
+            return login(session, *userId, std::string(line.substr(passwordStart)));
+        }
+        if (name == "LOGOUT") {
+            session.user.reset();
+            return render(Response::ok());
+        }
+
+        const auto& commands = commandTable();
+        auto it = commands.find(name);
+        if (it == commands.end()) {
+            return render(Response::fail("Неизвестная команда: " + std::string(name)));
+        }
+
+        const Command& command = it->second;
+        if (!session.user) {
+            return render(Response::fail("Требуется вход (LOGIN <user_id> <пароль>)"));
+        }
+
+        auto checkAccess = User::getAccessChecker();
+        if (command.role && !checkAccess(*session.user, command.role)) {
+            return render(Response::fail("Доступ запрещен"));
+        }
+        if (args.size() < command.minArgs || args.size() > command.maxArgs) {
+            return render(Response::fail(std::string("Использование: ") + command.usage));
+        }
+
+        return render(command.run(*session.user, args));
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("Ошибка выполнения запроса " << name << ": " << e.what());
+        return render(Response::fail("Внутренняя ошибка сервера"));
+    }
+}
+
+std::string StoreServer::login(ServerSession& session, int userId, const std::string& password) {
+    // Неудачный вход завершает прежний вход сессии
+    session.user.reset();
+
+    auto result = db->queryPrepared<std::string, std::string, std::string, std::optional<int>>(
+        "server_user_login", userId, password);
+    if (result.empty()) {
+        // Один ответ для неизвестного пользователя и неверного пароля
+        LOG_WARNING("Неудачный вход по сети: user_id " << userId);
+        if (++session.failedLogins >= MAX_LOGIN_ATTEMPTS) {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            session.closeRequested = true;
+        }
+        return render(Response::fail("Неверный ID пользователя или пароль"));
+    }
+    session.failedLogins = 0;
+
+    auto [userName, email, role, loyalty] = result[0];
+
+    std::shared_ptr<User> user;
+    if (role == "admin") {
+        user = std::make_shared<Admin>(userId, userName, email, db);
+    } else if (role == "manager") {
+        user = std::make_shared<Manager>(userId, userName, email, db);
+    } else if (role == "customer") {
+        user = std::make_shared<Customer>(userId, userName, email, loyalty.value_or(0), db);
+    } else {
+        return render(Response::fail("Неизвестная роль пользователя: " + role));
+    }
+
+    user->setAuditQueue(auditQueue);
+    user->setProductCache(productCache);
+    session.user = std::move(user);
+
+    LOG_INFO("Вход по сети: " << userName << " (" << role << ")");
+    return render(Response::row({std::to_string(userId), role, userName}));
+}
@@ -0,0 +1,61 @@
+// src/TablePrinter.cpp
+#include "../include/TablePrinter.h"
+#include <algorithm>
+#include <iomanip>
+
+// Вывод заголовка таблицы
+void printTableHeader(const std::vector<std::string>& headers,
+                      const std::vector<size_t>& columnWidths,
+                      std::ostream& out) {
+    out << "\n";
+    for (size_t i = 0; i < headers.size(); i++) {
+        out << std::left << std::setw(columnWidths[i] + 2) << headers[i];
+    }
+    out << "\n";
+
+    // Линия под заголовками
+    for (size_t i = 0; i < headers.size(); i++) {
+        out << std::string(columnWidths[i] + 2, '-');
+    }
+    out << "\n";
+}
+
+// Вывод одной строки таблицы
+void printTableRow(const std::vector<std::string>& row,
+                   const std::vector<size_t>& columnWidths,
+                   std::ostream& out) {
+    for (size_t i = 0; i < row.size() && i < columnWidths.size(); i++) {
+        out << std::left << std::setw(columnWidths[i] + 2) << row[i];
+    }
+    out << "\n";
+}
+
+// Функция для отображения таблицы
+void printTable(const std::vector<std::vector<std::string>>& data,
+                const std::vector<std::string>& headers,
+                std::ostream& out) {
+    if (data.empty()) {
+        out << "Нет данных для отображения" << std::endl;
+        return;
+    }
+
+    std::vector<size_t> columnWidths(headers.size(), 0);
+
+    for (size_t i = 0; i < headers.size(); i++) {
+        columnWidths[i] = std::max(columnWidths[i], headers[i].length());
+    }
+
+    for (const auto& row : data) {
+        for (size_t i = 0; i < row.size() && i < headers.size(); i++) {
+            columnWidths[i] = std::max(columnWidths[i], row[i].length());
+        }
+    }
+
+    // Выводим заголовки
+    printTableHeader(headers, columnWidths, out);
+
+    // Выводим данные
+    for (const auto& row : data) {
+        printTableRow(row, columnWidths, out);
+    }
+}
@@ -2,8 +2,64 @@
 #include "../include/DatabaseConnection.h"
 #include "../include/User.h"
 #include "../include/Order.h"
-#include <iostream>
+#include "../include/Logger.h"
+#include "../include/CsvWriter.h"
+#include "../include/AuditQueue.h"
+#include "../include/ProductCache.h"
+#include "../include/OrderColumns.h"
+#include "../include/OrderHistory.h"
+#include <algorithm>
 #include <sstream>
+#include <optional>
+
+namespace {
+    // Запрос списка всех заказов: используется и подготовленным запросом,
+    // и серверным курсором при потоковом чтении
+    const char* const ALL_ORDERS_SQL =
+        "SELECT o.order_id, u.name as customer, o.status, "
+        "o.total_price, o.order_date, o.items_count "
+        "FROM orders o "
+        "JOIN users u ON o.user_id = u.user_id "
+        "ORDER BY o.order_date DESC, o.order_id DESC";
+
+    // Чтение страницы: размер приводится к 1..MAX_PAGE_SIZE, fetch(limit)
+    // читает pageSize + 1 строк - лишняя строка только показывает, что
+    // дальше есть данные. Курсор - ключ последней строки страницы.
+    template<typename Fetch>
+    Page fetchPage(std::size_t pageSize, std::size_t idColumn, std::size_t timeColumn,
+                   Fetch&& fetch) {
+        pageSize = std::clamp<std::size_t>(pageSize, 1, MAX_PAGE_SIZE);
+        std::vector<std::vector<std::string>> rows = fetch(pageSize + 1);
+
+        Page page;
+        if (rows.size() > pageSize) {
+            rows.resize(pageSize);
+            const auto& last = rows.back();
+            page.next = PageCursor{last[timeColumn], std::stoi(last[idColumn])};
+        }
+        page.rows = std::move(rows);
+        return page;
+    }
+
+    // Данные события утверждения заказа (audit_log.payload)
+    const char* const APPROVAL_PAYLOAD =
+        "{\"old_status\": \"pending\", \"new_status\": \"completed\"}";
+
+    // Данные события отмены заказа
+    const char* const CANCEL_PAYLOAD =
+        "{\"old_status\": \"pending\", \"new_status\": \"canceled\"}";
+
+    // Корзина -> JSON-массив [{"product_id": .., "quantity": ..}, ...]
+    void appendCartJson(const std::vector<std::pair<int, int>>& products, std::string& json) {
+        json += "[";
+        for (size_t i = 0; i < products.size(); ++i) {
+            json += "{\"product_id\": " + std::to_string(products[i].first) +
+                    ", \"quantity\": " + std::to_string(products[i].second) + "}";
+            if (i < products.size() - 1) json += ",";
+        }
+        json += "]";
+    }
+}
 
 //  РЕАЛИЗАЦИЯ БАЗОВОГО КЛАССА User
 User::User(int id, const std::string& name, const std::string& email,
@@ -19,177 +75,398 @@ std::vector<std::shared_ptr<Order>> User::getOrders() const {
     return orders;
 }
 
+void User::setAuditQueue(std::shared_ptr<AuditQueue> queue) {
+    auditQueue = std::move(queue);
+}
+
+void User::setProductCache(std::shared_ptr<ProductCache> cache) {
+    productCache = std::move(cache);
+}
+
+bool User::writeAudit(const std::string& entityType, std::optional<int> entityId,
+                      const std::string& operation, AuditAction action,
+                      const std::string& details, std::optional<std::string> payload) {
+    if (auditQueue) {
+        return auditQueue->enqueue(AuditEvent{entityType, entityId, operation, action,
+                                              userId, details, std::move(payload)});
+    }
+
+    // Без очереди - синхронная запись (в текущей транзакции, если она открыта)
+    return db->executePreparedNonQuery("audit_insert", entityType, entityId,
+                                       operation, userId, details,
+                                       toString(action), payload);
+}
+
+std::vector<std::vector<std::string>> User::getOrderStatusHistory(int orderId) {
+    return db->executePrepared("order_status_history", orderId);
+}
+
+std::vector<std::vector<std::string>> User::getAvailableProducts() {
+    if (!productCache) {
+        return db->executePrepared("products_available");
+    }
+
+    // Каталог из памяти
+    std::vector<std::vector<std::string>> rows;
+    for (auto& product : productCache->getAvailable()) {
+        rows.push_back({std::to_string(product.productId), std::move(product.name),
+                        product.price.toString(), std::to_string(product.stockQuantity)});
+    }
+    return rows;
+}
+
+// ПОДГОТОВЛЕННЫЕ ЗАПРОСЫ
+// Все горячие запросы разбираются и планируются сервером один раз
+// на соединение, дальше выполняются только с новыми параметрами.
+void User::registerStatements(DatabaseConnection<std::string>& db) {
+    //  Заказы
+    db.registerStatement("order_status_fn",
+        "SELECT getOrderStatus($1)");
+    db.registerStatement("order_status_by_id",
+        "SELECT status FROM orders WHERE order_id = $1");
+    db.registerStatement("order_status_by_owner",
+        "SELECT status FROM orders WHERE order_id = $1 AND user_id = $2");
+    db.registerStatement("order_owner_by_id",
+        "SELECT user_id FROM orders WHERE order_id = $1");
+    db.registerStatement("order_pending_check",
+        "SELECT status FROM orders WHERE order_id = $1 AND status = 'pending' FOR UPDATE");
+    db.registerStatement("order_set_status",
+        "UPDATE orders SET status = $2 WHERE order_id = $1");
+    db.registerStatement("order_pay",
+        "UPDATE orders SET status = 'completed', payment_method = $2, "
+        "payment_status = 'paid' WHERE order_id = $1");
+    // Возврат с проверкой владельца и срока в одном запросе.
+    // Всегда одна строка: (возвращен, заказ принадлежит пользователю) -
+    // причина отказа видна по тому же снимку, без повторного запроса
+    db.registerStatement("order_return_guarded",
+        "WITH returned AS ("
+        "  UPDATE orders SET status = 'returned' "
+        "  WHERE order_id = $1 AND user_id = $2 AND canReturnOrder($1) "
+        "  RETURNING order_id) "
+        "SELECT EXISTS (SELECT 1 FROM returned), "
+        "EXISTS (SELECT 1 FROM orders WHERE order_id = $1 AND user_id = $2)");
+    db.registerStatement("order_create_proc",
+        "CALL createOrder($1, $2::jsonb, NULL, NULL)");
+    db.registerStatement("orders_create_batch",
+        "SELECT cart_index, new_order_id, error_message FROM createOrders($1, $2::jsonb)");
+    db.registerStatement("order_cancel_proc",
+        "CALL cancelOrder($1, $2, NULL, NULL)");
+    db.registerStatement("order_update_status_proc",
+        "CALL updateOrderStatus($1, $2, $3, NULL)");
+    db.registerStatement("order_status_history",
+        "SELECT * FROM getOrderStatusHistory($1)");
+
+    //  Элементы заказа
+    db.registerStatement("order_item_insert",
+        "INSERT INTO order_items (order_id, product_id, quantity, price) "
+        "VALUES ($1, $2, $3, $4)");
+    // Вставка с проверкой владельца и статуса в одном запросе.
+    // Цена берется из products на сервере, заказ блокируется от смены статуса.
+    // Всегда одна строка: (ID позиции или NULL, статус своего заказа или NULL,
+    // товар существует) - причина отказа приходит вместе с результатом
+    db.registerStatement("order_item_add_guarded",
+        "WITH o AS ("
+        "  SELECT order_id, status FROM orders "
+        "  WHERE order_id = $1 AND user_id = $4 FOR SHARE), "
+        "inserted AS ("
+        "  INSERT INTO order_items (order_id, product_id, quantity, price) "
+        "  SELECT o.order_id, p.product_id, $3, p.price "
+        "  FROM o JOIN products p ON p.product_id = $2 "
+        "  WHERE o.status = 'pending' "
+        "  RETURNING order_item_id) "
+        "SELECT (SELECT order_item_id FROM inserted), (SELECT status FROM o), "
+        "EXISTS (SELECT 1 FROM products WHERE product_id = $2)");
+    db.registerStatement("order_item_owner_check",
+        "SELECT o.order_id FROM order_items oi "
+        "JOIN orders o ON oi.order_id = o.order_id "
+        "WHERE oi.order_item_id = $1 AND o.user_id = $2 AND o.status = 'pending'");
+    db.registerStatement("order_item_delete",
+        "DELETE FROM order_items WHERE order_item_id = $1");
+
+    //  Товары
+    db.registerStatement("product_insert",
+        "INSERT INTO products (name, price, stock_quantity) VALUES ($1, $2, $3)");
+    db.registerStatement("product_update",
+        "UPDATE products SET name = $2, price = $3, stock_quantity = $4 "
+        "WHERE product_id = $1");
+    // Задания пересчета цен (см. processRepriceJobs)
+    db.registerStatement("reprice_jobs_recent",
+        "SELECT job_id, product_id, status, items_done, items_total, "
+        "created_at, finished_at "
+        "FROM reprice_jobs ORDER BY job_id DESC LIMIT 50");
+    db.registerStatement("product_delete",
+        "DELETE FROM products WHERE product_id = $1");
+    db.registerStatement("product_set_stock",
+        "UPDATE products SET stock_quantity = $2 WHERE product_id = $1");
+    db.registerStatement("products_available",
+        "SELECT product_id, name, price, stock_quantity FROM products "
+        "WHERE stock_quantity > 0 ORDER BY product_id");
+    // Запросы кэша каталога (ProductCache)
+    db.registerStatement("product_by_id",
+        "SELECT product_id, name, price, stock_quantity FROM products WHERE product_id = $1");
+    db.registerStatement("products_all",
+        "SELECT product_id, name, price, stock_quantity FROM products");
+    db.registerStatement("products_by_ids",
+        "SELECT product_id, name, price, stock_quantity FROM products "
+        "WHERE product_id = ANY($1::int[])");
+
+    //  Аудит
+    db.registerStatement("audit_insert",
+        "INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, "
+        "action, payload) "
+        "VALUES ($1, $2, $3, $4, $5, $6::audit_action, $7::jsonb)");
+    // Пакетная запись из AuditQueue: столбцы передаются массивами,
+    // время - секундами Unix (в локальное время сессии, как CURRENT_TIMESTAMP)
+    db.registerStatement("audit_insert_batch",
+        "INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details, performed_at, "
+        "action, payload) "
+        "SELECT e.entity_type, e.entity_id, e.operation, e.performed_by, e.details, "
+        "to_timestamp(e.performed_at)::timestamp, e.action, e.payload "
+        "FROM unnest($1::varchar[], $2::int[], $3::varchar[], $4::int[], $5::text[], $6::float8[], "
+        "$7::audit_action[], $8::jsonb[]) "
+        "AS e(entity_type, entity_id, operation, performed_by, details, performed_at, action, payload)");
+    // Журнал аудита постранично: первая страница и страница после курсора
+    db.registerStatement("audit_recent_first",
+        "SELECT a.log_id, a.entity_type, a.entity_id, a.operation, "
+        "u.name as performed_by, a.performed_at, a.details "
+        "FROM audit_log a "
+        "LEFT JOIN users u ON a.performed_by = u.user_id "
+        "WHERE a.performed_at >= CURRENT_TIMESTAMP - make_interval(days => $1) "
+        "ORDER BY a.performed_at DESC, a.log_id DESC "
+        "LIMIT $2");
+    db.registerStatement("audit_recent_next",
+        "SELECT a.log_id, a.entity_type, a.entity_id, a.operation, "
+        "u.name as performed_by, a.performed_at, a.details "
+        "FROM audit_log a "
+        "LEFT JOIN users u ON a.performed_by = u.user_id "
+        "WHERE a.performed_at >= CURRENT_TIMESTAMP - make_interval(days => $1) "
+        "AND (a.performed_at, a.log_id) < ($2::timestamp, $3) "
+        "ORDER BY a.performed_at DESC, a.log_id DESC "
+        "LIMIT $4");
+    db.registerStatement("audit_by_user",
+        "SELECT * FROM getAuditLogByUser($1)");
+
+    //  Списки заказов (постранично: *_first и *_next после курсора)
+    db.registerStatement("orders_all_first",
+        "SELECT o.order_id, u.name as customer, o.status, "
+        "o.total_price, o.order_date, o.items_count "
+        "FROM orders o "
+        "JOIN users u ON o.user_id = u.user_id "
+        "ORDER BY o.order_date DESC, o.order_id DESC "
+        "LIMIT $1");
+    db.registerStatement("orders_all_next",
+        "SELECT o.order_id, u.name as customer, o.status, "
+        "o.total_price, o.order_date, o.items_count "
+        "FROM orders o "
+        "JOIN users u ON o.user_id = u.user_id "
+        "WHERE (o.order_date, o.order_id) < ($1::timestamp, $2) "
+        "ORDER BY o.order_date DESC, o.order_id DESC "
+        "LIMIT $3");
+    // Ожидающие заказы - в порядке поступления
+    db.registerStatement("orders_pending_first",
+        "SELECT o.order_id, u.name as customer, o.total_price, "
+        "o.order_date, o.items_count "
+        "FROM orders o "
+        "JOIN users u ON o.user_id = u.user_id "
+        "WHERE o.status = 'pending' "
+        "ORDER BY o.order_date, o.order_id "
+        "LIMIT $1");
+    db.registerStatement("orders_pending_next",
+        "SELECT o.order_id, u.name as customer, o.total_price, "
+        "o.order_date, o.items_count "
+        "FROM orders o "
+        "JOIN users u ON o.user_id = u.user_id "
+        "WHERE o.status = 'pending' "
+        "AND (o.order_date, o.order_id) > ($1::timestamp, $2) "
+        "ORDER BY o.order_date, o.order_id "
+        "LIMIT $3");
+    // Утверждения менеджера - диапазон индекса (performed_by, action, entity_id)
+    db.registerStatement("orders_approved_by_manager",
+        "SELECT o.order_id, u.name as customer, o.total_price, "
+        "o.order_date, o.status "
+        "FROM (SELECT DISTINCT a.entity_id FROM audit_log a "
+        "WHERE a.performed_by = $1 AND a.action = 'order_approved') ap "
+        "JOIN orders o ON o.order_id = ap.entity_id "
+        "JOIN users u ON o.user_id = u.user_id "
+        "WHERE o.status = 'completed' "
+        "ORDER BY o.order_date DESC");
+    db.registerStatement("orders_by_user_first",
+        "SELECT o.order_id, o.status, o.total_price, o.order_date, o.items_count "
+        "FROM orders o "
+        "WHERE o.user_id = $1 "
+        "ORDER BY o.order_date DESC, o.order_id DESC "
+        "LIMIT $2");
+    db.registerStatement("orders_by_user_next",
+        "SELECT o.order_id, o.status, o.total_price, o.order_date, o.items_count "
+        "FROM orders o "
+        "WHERE o.user_id = $1 "
+        "AND (o.order_date, o.order_id) < ($2::timestamp, $3) "
+        "ORDER BY o.order_date DESC, o.order_id DESC "
+        "LIMIT $4");
+}
+
 //  РЕАЛИЗАЦИЯ КЛАССА Admin
 Admin::Admin(int id, const std::string& name, const std::string& email,
              std::shared_ptr<DatabaseConnection<std::string>> dbConn)
     : User(id, name, email, "admin", dbConn) {}
 
 // Реализация виртуальных функций Admin
-void Admin::createOrder(const std::vector<std::pair<int, int>>& products) {
-    std::cout << "Администратор создает заказ..." << std::endl;
-    // Админ может создавать заказы для других пользователей
+ActionResult Admin::createOrder(const std::vector<std::pair<int, int>>& products) {
+    // Заказ оформляется от имени покупателя (Customer::createOrder)
+    return ActionResult::failure("Администратор не оформляет заказы от своего имени");
 }
 
 std::string Admin::viewOrderStatus(int orderId) {
-    auto result = db->executeQuery(
-        "SELECT getOrderStatus(" + std::to_string(orderId) + ")"
-    );
+    auto result = db->queryPrepared<std::string>("order_status_fn", orderId);
 
-    if (!result.empty() && !result[0].empty()) {
-        return result[0][0];
+    if (!result.empty()) {
+        return std::get<0>(result[0]);
     }
     return "Заказ не найден";
 }
 
-bool Admin::cancelOrder(int orderId) {
-    // Используем транзакцию для отмены заказа
-    db->beginTransaction();
-
-    try {
-        // 1. Обновляем статус заказа
-        bool success = db->executeNonQuery(
-            "UPDATE orders SET status = 'canceled' WHERE order_id = " +
-            std::to_string(orderId)
-        );
-
-        if (!success) {
-            db->rollbackTransaction();
-            return false;
-        }
-
-        // 2. Возвращаем товары на склад
-        auto items = db->executeQuery(
-            "SELECT product_id, quantity FROM order_items WHERE order_id = " +
-            std::to_string(orderId)
-        );
-
-        for (const auto& item : items) {
-            if (item.size() >= 2) {
-                std::string updateStock =
-                    "UPDATE products SET stock_quantity = stock_quantity + " +
-                    item[1] + " WHERE product_id = " + item[0];
-
-                if (!db->executeNonQuery(updateStock)) {
-                    db->rollbackTransaction();
-                    return false;
-                }
-            }
-        }
-
-        // 3. Записываем в аудит
-        std::string auditSQL =
-            "INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details) "
-            "VALUES ('order', " + std::to_string(orderId) + ", 'update', " +
-            std::to_string(userId) + ", 'Заказ отменен администратором')";
+ActionResult Admin::cancelOrder(int orderId) {
+    // Хранимая процедура cancelOrder за один вызов возвращает товары
+    // на склад, меняет статус и пишет аудит (в одной транзакции сервера)
+    auto result = db->queryPrepared<bool, std::optional<std::string>>(
+        "order_cancel_proc", orderId, userId);
 
-        if (!db->executeNonQuery(auditSQL)) {
-            db->rollbackTransaction();
-            return false;
-        }
-
-        db->commitTransaction();
-        return true;
+    if (result.empty()) {
+        return ActionResult::failure("Ошибка при отмене заказа");
+    }
 
-    } catch (const std::exception& e) {
-        db->rollbackTransaction();
-        std::cerr << "Ошибка при отмене заказа: " << e.what() << std::endl;
-        return false;
+    auto [canceled, message] = result[0];
+    if (!canceled) {
+        return ActionResult::failure(message.value_or("Заказ не отменен"));
     }
+    return ActionResult::success();
 }
 
 // Специфичные методы Admin
-bool Admin::addProduct(const std::string& name, double price, int stockQuantity) {
-    std::string sql =
-        "INSERT INTO products (name, price, stock_quantity) VALUES ('" +
-        name + "', " + std::to_string(price) + ", " +
-        std::to_string(stockQuantity) + ")";
-
-    bool success = db->executeNonQuery(sql);
-
-    if (success) {
-        // Аудит операции
-        std::string auditSQL =
-            "INSERT INTO audit_log (entity_type, operation, performed_by, details) "
-            "VALUES ('product', 'insert', " + std::to_string(userId) +
-            ", 'Добавлен товар: " + name + "')";
-        db->executeNonQuery(auditSQL);
+bool Admin::addProduct(const std::string& name, Money price, int stockQuantity) {
+    if (!db->executePreparedNonQuery("product_insert", name, price, stockQuantity)) {
+        return false;
     }
 
-    return success;
+    // Аудит операции
+    writeAudit("product", std::nullopt, "insert", AuditAction::ProductCreated,
+               "Добавлен товар: " + name,
+               "{\"price\": " + price.toString() + ", \"stock_quantity\": " +
+               std::to_string(stockQuantity) + "}");
+    return true;
 }
 
 bool Admin::updateProduct(int productId, const std::string& name,
-                         double price, int stockQuantity) {
-    std::string sql =
-        "UPDATE products SET name = '" + name + "', price = " +
-        std::to_string(price) + ", stock_quantity = " +
-        std::to_string(stockQuantity) + " WHERE product_id = " +
-        std::to_string(productId);
-
-    return db->executeNonQuery(sql);
+                         Money price, int stockQuantity) {
+    // Заказы пересчитывает триггер: небольшие - сразу по разнице цен,
+    // крупные - фоновым заданием (RepriceWorker)
+    return db->executePreparedNonQuery("product_update", productId, name, price, stockQuantity);
 }
 
 bool Admin::deleteProduct(int productId) {
-    std::string sql =
-        "DELETE FROM products WHERE product_id = " + std::to_string(productId);
+    return db->executePreparedNonQuery("product_delete", productId);
+}
 
-    return db->executeNonQuery(sql);
+Page Admin::viewAllOrders(std::size_t pageSize, const std::optional<PageCursor>& after) {
+    // Колонки: order_id (0), ..., order_date (4)
+    return fetchPage(pageSize, 0, 4, [&](std::size_t limit) {
+        return after
+            ? db->executePrepared("orders_all_next", after->lastTime, after->lastId, limit)
+            : db->executePrepared("orders_all_first", limit);
+    });
 }
 
-std::vector<std::vector<std::string>> Admin::viewAllOrders() {
-    return db->executeQuery(
-        "SELECT o.order_id, u.name as customer, o.status, "
-        "o.total_price, o.order_date, COUNT(oi.order_item_id) as items_count "
-        "FROM orders o "
-        "JOIN users u ON o.user_id = u.user_id "
-        "LEFT JOIN order_items oi ON o.order_id = oi.order_id "
-        "GROUP BY o.order_id, u.name, o.status, o.total_price, o.order_date "
-        "ORDER BY o.order_date DESC"
-    );
+std::size_t Admin::streamAllOrders(
+    const std::function<void(const std::vector<std::string>&)>& onRow,
+    std::size_t chunkSize) {
+    return db->streamRows(ALL_ORDERS_SQL, chunkSize, onRow);
+}
+
+OrderColumns Admin::loadOrderSnapshot() {
+    return OrderColumns::load(*db);
 }
 
-bool Admin::updateOrderStatus(int orderId, const std::string& newStatus) {
-    // Используем хранимую процедуру
-    std::string sql =
-        "CALL updateOrderStatus(" + std::to_string(orderId) + ", '" +
-        newStatus + "', " + std::to_string(userId) + ", NULL)";
+ActionResult Admin::updateOrderStatus(int orderId, OrderStatus newStatus) {
+    // В этот статус нельзя перейти ни из какого - не тратим запрос
+    if (!isReachable(newStatus)) {
+        return ActionResult::failure("Нельзя перевести заказ в статус " +
+                                     std::string(toString(newStatus)));
+    }
 
-    return db->executeNonQuery(sql);
+    // Хранимая процедура проверяет переход от текущего статуса
+    if (!db->executePreparedNonQuery("order_update_status_proc", orderId,
+                                     toString(newStatus), userId)) {
+        return ActionResult::failure("Заказ не найден или переход статуса недопустим");
+    }
+    return ActionResult::success();
 }
 
-std::vector<std::vector<std::string>> Admin::getAuditLog() {
-    return db->executeQuery(
-        "SELECT a.log_id, a.entity_type, a.entity_id, a.operation, "
-        "u.name as performed_by, a.performed_at, a.details "
-        "FROM audit_log a "
-        "LEFT JOIN users u ON a.performed_by = u.user_id "
-        "ORDER BY a.performed_at DESC "
-        "LIMIT 100"
-    );
+Page Admin::getAuditLog(int days, std::size_t pageSize, const std::optional<PageCursor>& after) {
+    // Окно по performed_at: читаются только секции последних месяцев.
+    // Колонки: log_id (0), ..., performed_at (5)
+    return fetchPage(pageSize, 0, 5, [&](std::size_t limit) {
+        return after
+            ? db->executePrepared("audit_recent_next", days, after->lastTime, after->lastId, limit)
+            : db->executePrepared("audit_recent_first", days, limit);
+    });
 }
 
 std::vector<std::vector<std::string>> Admin::getAuditLogByUser(int userId) {
-    return db->executeQuery(
-        "SELECT * FROM getAuditLogByUser(" + std::to_string(userId) + ")"
-    );
+    return db->executePrepared("audit_by_user", userId);
+}
+
+std::vector<std::vector<std::string>> Admin::getRepriceJobs() {
+    return db->executePrepared("reprice_jobs_recent");
 }
 
 bool Admin::generateCSVReport(const std::string& filename) {
-    std::cout << "Генерация CSV отчета: " << filename << std::endl;
+    // По умолчанию - последние 30 дней
+    return generateCSVReport(filename, std::nullopt, std::nullopt);
+}
 
-    auto reportData = db->executeQuery(
-        "SELECT o.order_id, u.name as customer, o.status, "
-        "h.new_status, h.changed_at, a.operation, a.performed_at, a.details "
-        "FROM orders o "
-        "LEFT JOIN users u ON o.user_id = u.user_id "
-        "LEFT JOIN order_status_history h ON o.order_id = h.order_id "
-        "LEFT JOIN audit_log a ON o.order_id = a.entity_id AND a.entity_type = 'order' "
-        "WHERE o.order_date >= CURRENT_DATE - INTERVAL '30 days' "
-        "ORDER BY o.order_id, h.changed_at"
-    );
+bool Admin::generateCSVReport(const std::string& filename,
+                              const std::optional<std::string>& startDate,
+                              const std::optional<std::string>& endDate) {
+    LOG_INFO("Генерация CSV отчета: " << filename);
+
+    CsvWriter writer(filename);
+    if (!writer.isOpen()) {
+        return false;
+    }
+
+    writer.writeRow({"ID заказа", "Покупатель", "Статус заказа", "Сумма заказа", "Дата заказа",
+                     "Последнее изменение статуса", "Кол-во изменений статуса",
+                     "Последняя операция аудита", "Время последнего аудита",
+                     "Всего записей аудита"});
+
+    // Строки читаются через курсор порциями и сразу уходят в буфер файла,
+    // поэтому память не зависит от размера отчета
+    std::size_t rowCount = 0;
+    try {
+        rowCount = db->streamQuery(
+            "SELECT * FROM generateAuditReport("
+            "COALESCE($1::date, CURRENT_DATE - 30), COALESCE($2::date, CURRENT_DATE))",
+            1000,
+            [&writer](const pqxx::row& row) {
+                for (const auto& field : row) {
+                    writer.writeField(field.is_null() ? std::string_view("Нет данных")
+                                                      : field.view());
+                }
+                writer.endRow();
+            },
+            startDate, endDate);
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("Ошибка формирования отчета: " << e.what());
+        return false;
+    }
 
-    std::cout << "Отчет содержит " << reportData.size() << " записей" << std::endl;
-    return !reportData.empty();
+    if (!writer.close()) {
+        return false;
+    }
+
+    LOG_INFO("Отчет содержит " << rowCount << " записей");
+    return true;
 }
 
 //  РЕАЛИЗАЦИЯ КЛАССА Manager
@@ -198,136 +475,108 @@ Manager::Manager(int id, const std::string& name, const std::string& email,
     : User(id, name, email, "manager", dbConn) {}
 
 // Реализация виртуальных функций Manager
-void Manager::createOrder(const std::vector<std::pair<int, int>>& products) {
-    std::cout << "Менеджер создает заказ..." << std::endl;
-    // Менеджер может создавать заказы для клиентов
+ActionResult Manager::createOrder(const std::vector<std::pair<int, int>>& products) {
+    // Заказ оформляется от имени покупателя (Customer::createOrder)
+    return ActionResult::failure("Менеджер не оформляет заказы от своего имени");
 }
 
 std::string Manager::viewOrderStatus(int orderId) {
-    auto result = db->executeQuery(
-        "SELECT status FROM orders WHERE order_id = " + std::to_string(orderId)
-    );
+    auto result = db->queryPrepared<std::string>("order_status_by_id", orderId);
 
-    if (!result.empty() && !result[0].empty()) {
-        return result[0][0];
+    if (!result.empty()) {
+        return std::get<0>(result[0]);
     }
     return "Заказ не найден";
 }
 
-bool Manager::cancelOrder(int orderId) {
+ActionResult Manager::cancelOrder(int orderId) {
     // Менеджер может отменять только pending заказы
-    auto statusResult = db->executeQuery(
-        "SELECT status FROM orders WHERE order_id = " + std::to_string(orderId)
-    );
+    auto statusResult = db->queryPrepared<OrderStatus>("order_status_by_id", orderId);
 
-    if (!statusResult.empty() && statusResult[0][0] == "pending") {
-        return db->executeNonQuery(
-            "UPDATE orders SET status = 'canceled' WHERE order_id = " +
-            std::to_string(orderId)
-        );
+    if (statusResult.empty()) {
+        return ActionResult::failure("Заказ не найден");
     }
-    return false;
+    if (std::get<0>(statusResult[0]) != OrderStatus::Pending) {
+        return ActionResult::failure("Отменить можно только ожидающий заказ");
+    }
+    if (!db->executePreparedNonQuery("order_set_status", orderId,
+                                     toString(OrderStatus::Canceled))) {
+        return ActionResult::failure("Ошибка при отмене заказа");
+    }
+    writeAudit("order", orderId, "update", AuditAction::OrderCanceled,
+               "Заказ отменен менеджером", std::string(CANCEL_PAYLOAD));
+    return ActionResult::success();
 }
 
 // спецц методы Manager
-bool Manager::approveOrder(int orderId) {
+ActionResult Manager::approveOrder(int orderId) {
     // Используем транзакцию для утверждения заказа
     db->beginTransaction();
 
     try {
         // 1. Проверяем, что заказ существует и в статусе pending
-        auto checkResult = db->executeQuery(
-            "SELECT status FROM orders WHERE order_id = " +
-            std::to_string(orderId) + " AND status = 'pending'"
-        );
+        auto checkResult = db->executePrepared("order_pending_check", orderId);
 
         if (checkResult.empty()) {
             db->rollbackTransaction();
-            return false;
+            return ActionResult::failure("Заказ не найден или не ожидает утверждения");
         }
 
         // 2. Обновляем статус на completed
-        bool success = db->executeNonQuery(
-            "UPDATE orders SET status = 'completed' WHERE order_id = " +
-            std::to_string(orderId)
-        );
+        bool success = db->executePreparedNonQuery("order_set_status", orderId,
+                                                   toString(OrderStatus::Completed));
 
         if (!success) {
             db->rollbackTransaction();
-            return false;
+            return ActionResult::failure("Ошибка при утверждении заказа");
         }
 
         // 3. Записываем в аудит
-        std::string auditSQL =
-            "INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details) "
-            "VALUES ('order', " + std::to_string(orderId) + ", 'update', " +
-            std::to_string(userId) + ", 'Заказ утвержден менеджером')";
-
-        if (!db->executeNonQuery(auditSQL)) {
+        if (!db->executePreparedNonQuery("audit_insert", "order", std::optional<int>(orderId),
+                                         "update", userId, "Заказ утвержден менеджером",
+                                         toString(AuditAction::OrderApproved),
+                                         APPROVAL_PAYLOAD)) {
             db->rollbackTransaction();
-            return false;
+            return ActionResult::failure("Ошибка записи аудита");
         }
 
         db->commitTransaction();
-        return true;
+        return ActionResult::success();
 
     } catch (const std::exception& e) {
         db->rollbackTransaction();
-        std::cerr << "Ошибка при утверждении заказа: " << e.what() << std::endl;
-        return false;
+        LOG_ERROR("Ошибка при утверждении заказа: " << e.what());
+        return ActionResult::failure("Ошибка при утверждении заказа");
     }
 }
 
-bool Manager::updateStock(int productId, int newQuantity) {
+ActionResult Manager::updateStock(int productId, int newQuantity) {
     if (newQuantity < 0) {
-        std::cerr << "Количество не может быть отрицательным" << std::endl;
-        return false;
+        return ActionResult::failure("Количество не может быть отрицательным");
     }
 
-    std::string sql =
-        "UPDATE products SET stock_quantity = " + std::to_string(newQuantity) +
-        " WHERE product_id = " + std::to_string(productId);
-
-    bool success = db->executeNonQuery(sql);
-
-    if (success) {
-        // Аудит операции
-        std::string auditSQL =
-            "INSERT INTO audit_log (entity_type, entity_id, operation, performed_by, details) "
-            "VALUES ('product', " + std::to_string(productId) + ", 'update', " +
-            std::to_string(userId) + ", 'Обновлено количество на складе: " +
-            std::to_string(newQuantity) + "')";
-        db->executeNonQuery(auditSQL);
+    if (!db->executePreparedNonQuery("product_set_stock", productId, newQuantity)) {
+        return ActionResult::failure("Ошибка при обновлении количества");
     }
 
-    return success;
+    // Аудит операции
+    writeAudit("product", productId, "update", AuditAction::StockUpdated,
+               "Обновлено количество на складе: " + std::to_string(newQuantity),
+               "{\"stock_quantity\": " + std::to_string(newQuantity) + "}");
+    return ActionResult::success();
 }
 
-std::vector<std::vector<std::string>> Manager::getPendingOrders() {
-    return db->executeQuery(
-        "SELECT o.order_id, u.name as customer, o.total_price, "
-        "o.order_date, COUNT(oi.order_item_id) as items_count "
-        "FROM orders o "
-        "JOIN users u ON o.user_id = u.user_id "
-        "LEFT JOIN order_items oi ON o.order_id = oi.order_id "
-        "WHERE o.status = 'pending' "
-        "GROUP BY o.order_id, u.name, o.total_price, o.order_date "
-        "ORDER BY o.order_date"
-    );
+Page Manager::getPendingOrders(std::size_t pageSize, const std::optional<PageCursor>& after) {
+    // Колонки: order_id (0), ..., order_date (3)
+    return fetchPage(pageSize, 0, 3, [&](std::size_t limit) {
+        return after
+            ? db->executePrepared("orders_pending_next", after->lastTime, after->lastId, limit)
+            : db->executePrepared("orders_pending_first", limit);
+    });
 }
 
 std::vector<std::vector<std::string>> Manager::getApprovedOrdersHistory() {
-    return db->executeQuery(
-        "SELECT o.order_id, u.name as customer, o.total_price, "
-        "o.order_date, o.status "
-        "FROM orders o "
-        "JOIN users u ON o.user_id = u.user_id "
-        "WHERE o.status = 'completed' "
-        "AND EXISTS (SELECT 1 FROM audit_log a WHERE a.entity_id = o.order_id "
-        "AND a.performed_by = " + std::to_string(userId) +
-        " AND a.details LIKE '%утвержден менеджером%') "
-        "ORDER BY o.order_date DESC"
-    );
+    return db->executePrepared("orders_approved_by_manager", userId);
 }
 
 // РЕАЛИЗАЦИЯ КЛАССА Customer
@@ -336,183 +585,203 @@ Customer::Customer(int id, const std::string& name, const std::string& email,
     : User(id, name, email, "customer", dbConn), loyaltyLevel(loyalty) {}
 
 // Реализация виртуальных функций Customer
-void Customer::createOrder(const std::vector<std::pair<int, int>>& products) {
+ActionResult Customer::createOrder(const std::vector<std::pair<int, int>>& products) {
     if (products.empty()) {
-        std::cout << "Нельзя создать пустой заказ!" << std::endl;
-        return;
+        return ActionResult::failure("Нельзя создать пустой заказ!");
     }
 
-    std::cout << "Создание заказа для клиента " << name << "..." << std::endl;
-
     // Преобразуем продукты в JSON для хранимой процедуры
-    std::string jsonProducts = "[";
-    for (size_t i = 0; i < products.size(); ++i) {
-        jsonProducts += "{\"product_id\": " + std::to_string(products[i].first) +
-                       ", \"quantity\": " + std::to_string(products[i].second) + "}";
-        if (i < products.size() - 1) jsonProducts += ",";
+    std::string jsonProducts;
+    appendCartJson(products, jsonProducts);
+
+    // Вызываем хранимую процедуру createOrder (возвращает new_order_id, result_message)
+    auto result = db->queryPrepared<std::optional<int>, std::optional<std::string>>(
+        "order_create_proc", userId, jsonProducts);
+
+    if (result.empty()) {
+        return ActionResult::failure("Ошибка при создании заказа");
     }
-    jsonProducts += "]";
 
-    // Вызываем хранимую процедуру createOrder
-    std::string sql = "CALL createOrder(" + std::to_string(userId) +
-                     ", '" + jsonProducts + "'::jsonb, NULL, NULL)";
+    auto [newOrderId, message] = result[0];
+    if (!newOrderId) {
+        return ActionResult::failure(message.value_or("Ошибка при создании заказа"));
+    }
+
+    LOG_INFO("Заказ #" << *newOrderId << " создан пользователем '" << name << "'");
+    return ActionResult::success("Номер заказа: " + std::to_string(*newOrderId));
+}
+
+std::vector<BatchOrderResult> Customer::createOrders(
+    const std::vector<std::vector<std::pair<int, int>>>& carts,
+    std::size_t chunkSize) {
+
+    std::vector<BatchOrderResult> results;
+    results.reserve(carts.size());
+    if (chunkSize == 0) {
+        chunkSize = 1;
+    }
+
+    // Каждая порция корзин уходит на сервер одним вызовом createOrders;
+    // ошибка в одной корзине не отменяет остальные
+    std::string jsonCarts;
+    for (std::size_t start = 0; start < carts.size(); start += chunkSize) {
+        std::size_t end = std::min(carts.size(), start + chunkSize);
+
+        jsonCarts.clear();
+        jsonCarts += "[";
+        for (std::size_t i = start; i < end; ++i) {
+            appendCartJson(carts[i], jsonCarts);
+            if (i + 1 < end) jsonCarts += ",";
+        }
+        jsonCarts += "]";
+
+        auto chunkResult = db->queryPrepared<int, std::optional<int>, std::optional<std::string_view>>(
+            "orders_create_batch", userId, jsonCarts);
+
+        if (chunkResult.empty()) {
+            // Вызов не удался целиком (взаимоблокировка повторяется в
+            // DatabaseConnection) - помечаем всю порцию, а не отдельные корзины
+            for (std::size_t i = start; i < end; ++i) {
+                results.push_back({static_cast<int>(i), std::nullopt, "Ошибка выполнения пакета"});
+            }
+            continue;
+        }
 
-    if (db->executeNonQuery(sql)) {
-        std::cout << "Заказ успешно создан!" << std::endl;
-    } else {
-        std::cout << "Ошибка при создании заказа" << std::endl;
+        for (const auto& [cartIndex, orderId, error] : chunkResult) {
+            results.push_back({static_cast<int>(start) + cartIndex, orderId,
+                               error ? std::string(*error) : std::string()});
+        }
     }
+
+    return results;
 }
 
 std::string Customer::viewOrderStatus(int orderId) {
     // Проверяем, что заказ принадлежит этому пользователю
-    auto checkResult = db->executeQuery(
-        "SELECT user_id FROM orders WHERE order_id = " + std::to_string(orderId)
-    );
+    auto checkResult = db->queryPrepared<int>("order_owner_by_id", orderId);
 
-    if (!checkResult.empty() && std::stoi(checkResult[0][0]) == userId) {
-        auto result = db->executeQuery(
-            "SELECT getOrderStatus(" + std::to_string(orderId) + ")"
-        );
+    if (!checkResult.empty() && std::get<0>(checkResult[0]) == userId) {
+        auto result = db->queryPrepared<std::string>("order_status_fn", orderId);
 
-        if (!result.empty() && !result[0].empty()) {
-            return result[0][0];
+        if (!result.empty()) {
+            return std::get<0>(result[0]);
         }
     }
 
     return "Заказ не найден или доступ запрещен";
 }
 
-bool Customer::cancelOrder(int orderId) {
+ActionResult Customer::cancelOrder(int orderId) {
     // Проверяем, что заказ принадлежит пользователю и в статусе pending
-    auto checkResult = db->executeQuery(
-        "SELECT status FROM orders WHERE order_id = " +
-        std::to_string(orderId) + " AND user_id = " + std::to_string(userId)
-    );
+    auto checkResult = db->queryPrepared<OrderStatus>("order_status_by_owner", orderId, userId);
 
-    if (!checkResult.empty() && checkResult[0][0] == "pending") {
-        return db->executeNonQuery(
-            "UPDATE orders SET status = 'canceled' WHERE order_id = " +
-            std::to_string(orderId)
-        );
+    if (checkResult.empty()) {
+        return ActionResult::failure("Заказ не найден среди ваших заказов");
+    }
+    if (std::get<0>(checkResult[0]) != OrderStatus::Pending) {
+        return ActionResult::failure("Отменить можно только ожидающий заказ");
+    }
+    if (!db->executePreparedNonQuery("order_set_status", orderId,
+                                     toString(OrderStatus::Canceled))) {
+        return ActionResult::failure("Ошибка при отмене заказа");
     }
-    return false;
+    writeAudit("order", orderId, "update", AuditAction::OrderCanceled,
+               "Заказ отменен покупателем", std::string(CANCEL_PAYLOAD));
+    return ActionResult::success();
 }
 
 // Спец методы Customer
-bool Customer::addToOrder(int orderId, int productId, int quantity) {
+ActionResult Customer::addToOrder(int orderId, int productId, int quantity) {
     if (quantity <= 0) {
-        std::cerr << "Количество должно быть больше 0" << std::endl;
-        return false;
+        return ActionResult::failure("Количество должно быть больше 0");
     }
 
-    // Проверяем, что заказ принадлежит пользователю и еще не завершен
-    auto checkResult = db->executeQuery(
-        "SELECT status FROM orders WHERE order_id = " +
-        std::to_string(orderId) + " AND user_id = " + std::to_string(userId)
-    );
-
-    if (checkResult.empty() || checkResult[0][0] != "pending") {
-        std::cerr << "Нельзя добавить товар в этот заказ" << std::endl;
-        return false;
+    // Проверка заказа, цена, вставка и причина отказа - один запрос
+    auto result = db->queryPrepared<std::optional<int>, std::optional<OrderStatus>, bool>(
+        "order_item_add_guarded", orderId, productId, quantity, userId);
+    if (result.empty()) {
+        return ActionResult::failure("Ошибка при добавлении товара");
     }
 
-    // Получаем цену продукта
-    auto priceResult = db->executeQuery(
-        "SELECT price FROM products WHERE product_id = " + std::to_string(productId)
-    );
-
-    if (priceResult.empty()) {
-        std::cerr << "Товар не найден" << std::endl;
-        return false;
+    auto [itemId, status, productExists] = result[0];
+    if (itemId) {
+        return ActionResult::success();
     }
 
-    double price = std::stod(priceResult[0][0]);
-
-    // Добавляем товар в заказ
-    std::string sql =
-        "INSERT INTO order_items (order_id, product_id, quantity, price) VALUES (" +
-        std::to_string(orderId) + ", " + std::to_string(productId) + ", " +
-        std::to_string(quantity) + ", " + std::to_string(price) + ")";
-
-    return db->executeNonQuery(sql);
+    if (!status) {
+        return ActionResult::failure("Заказ не найден среди ваших заказов");
+    }
+    if (*status != OrderStatus::Pending) {
+        return ActionResult::failure("Нельзя добавить товар в заказ в статусе " +
+                                     std::string(toString(*status)));
+    }
+    if (!productExists) {
+        return ActionResult::failure("Товар не найден");
+    }
+    return ActionResult::failure("Ошибка при добавлении товара");
 }
 
-bool Customer::removeFromOrder(int orderItemId) {
+ActionResult Customer::removeFromOrder(int orderItemId) {
     // Проверяем, что элемент заказа принадлежит заказу пользователя
-    auto checkResult = db->executeQuery(
-        "SELECT o.order_id FROM order_items oi "
-        "JOIN orders o ON oi.order_id = o.order_id "
-        "WHERE oi.order_item_id = " + std::to_string(orderItemId) +
-        " AND o.user_id = " + std::to_string(userId) +
-        " AND o.status = 'pending'"
-    );
+    auto checkResult = db->executePrepared("order_item_owner_check", orderItemId, userId);
 
     if (checkResult.empty()) {
-        std::cerr << "Нельзя удалить этот товар из заказа" << std::endl;
-        return false;
+        return ActionResult::failure("Позиция не найдена в ваших ожидающих заказах");
     }
 
-    std::string sql =
-        "DELETE FROM order_items WHERE order_item_id = " +
-        std::to_string(orderItemId);
-
-    return db->executeNonQuery(sql);
+    if (!db->executePreparedNonQuery("order_item_delete", orderItemId)) {
+        return ActionResult::failure("Ошибка при удалении товара");
+    }
+    return ActionResult::success();
 }
 
-bool Customer::makePayment(int orderId, const std::string& paymentMethod) {
+ActionResult Customer::makePayment(int orderId, const std::string& paymentMethod) {
     // Проверяем, что заказ принадлежит пользователю и в статусе pending
-    auto checkResult = db->executeQuery(
-        "SELECT status, total_price FROM orders WHERE order_id = " +
-        std::to_string(orderId) + " AND user_id = " + std::to_string(userId)
-    );
+    auto checkResult = db->queryPrepared<OrderStatus>("order_status_by_owner", orderId, userId);
 
-    if (checkResult.empty() || checkResult[0][0] != "pending") {
-        std::cerr << "Нельзя оплатить этот заказ" << std::endl;
-        return false;
+    if (checkResult.empty()) {
+        return ActionResult::failure("Заказ не найден среди ваших заказов");
+    }
+    if (std::get<0>(checkResult[0]) != OrderStatus::Pending) {
+        return ActionResult::failure("Оплатить можно только ожидающий заказ");
     }
 
     // Обновляем заказ - устанавливаем способ оплаты и статус
-    std::string sql =
-        "UPDATE orders SET status = 'completed', payment_method = '" +
-        paymentMethod + "', payment_status = 'paid' WHERE order_id = " +
-        std::to_string(orderId);
-
-    return db->executeNonQuery(sql);
-}
-
-bool Customer::returnOrder(int orderId) {
-    // Проверяем возможность возврата через функцию canReturnOrder
-    auto canReturnResult = db->executeQuery(
-        "SELECT canReturnOrder(" + std::to_string(orderId) + ")"
-    );
-
-    if (!canReturnResult.empty() && canReturnResult[0][0] == "t") {
-        // Проверяем, что заказ принадлежит пользователю
-        auto checkResult = db->executeQuery(
-            "SELECT user_id FROM orders WHERE order_id = " + std::to_string(orderId)
-        );
-
-        if (!checkResult.empty() && std::stoi(checkResult[0][0]) == userId) {
-            return db->executeNonQuery(
-                "UPDATE orders SET status = 'returned' WHERE order_id = " +
-                std::to_string(orderId)
-            );
-        }
+    if (!db->executePreparedNonQuery("order_pay", orderId, paymentMethod)) {
+        return ActionResult::failure("Ошибка при оплате заказа");
+    }
+    return ActionResult::success();
+}
+
+ActionResult Customer::returnOrder(int orderId) {
+    // Владелец, canReturnOrder, смена статуса и причина отказа - один запрос
+    auto result = db->queryPrepared<bool, bool>("order_return_guarded", orderId, userId);
+    if (result.empty()) {
+        return ActionResult::failure("Ошибка при оформлении возврата");
     }
 
-    std::cout << "Нельзя вернуть этот заказ" << std::endl;
-    return false;
+    auto [returned, owned] = result[0];
+    if (returned) {
+        return ActionResult::success();
+    }
+    if (!owned) {
+        return ActionResult::failure("Заказ не найден среди ваших заказов");
+    }
+    return ActionResult::failure("Заказ не завершен или прошло больше 30 дней");
 }
 
-std::vector<std::vector<std::string>> Customer::getMyOrderHistory() {
-    return db->executeQuery(
-        "SELECT o.order_id, o.status, o.total_price, o.order_date, "
-        "COUNT(oi.order_item_id) as items_count "
-        "FROM orders o "
-        "LEFT JOIN order_items oi ON o.order_id = oi.order_id "
-        "WHERE o.user_id = " + std::to_string(userId) +
-        " GROUP BY o.order_id, o.status, o.total_price, o.order_date "
-        "ORDER BY o.order_date DESC"
-    );
+Page Customer::getMyOrderHistory(std::size_t pageSize, const std::optional<PageCursor>& after) {
+    // Колонки: order_id (0), ..., order_date (3)
+    return fetchPage(pageSize, 0, 3, [&](std::size_t limit) {
+        return after
+            ? db->executePrepared("orders_by_user_next", userId, after->lastTime, after->lastId,
+                                  limit)
+            : db->executePrepared("orders_by_user_first", userId, limit);
+    });
+}
+
+std::unique_ptr<OrderHistory> Customer::loadOrderHistory() {
+    auto history = std::make_unique<OrderHistory>();
+    history->load(*db, userId);
+    return history;
 }
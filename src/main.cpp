@@ -5,52 +5,16 @@
 #include <string>
 #include <algorithm>
 #include <iomanip>
+#include <functional>
 #include "../include/DatabaseConnection.h"
 #include "../include/User.h"
 #include "../include/Order.h"
 #include "../include/Payment.h"
-
-// Функция для отображения таблицы
-void printTable(const std::vector<std::vector<std::string>>& data,
-                const std::vector<std::string>& headers) {
-    if (data.empty()) {
-        std::cout << "Нет данных для отображения" << std::endl;
-        return;
-    }
-
-    std::vector<size_t> columnWidths(headers.size(), 0);
-
-    for (size_t i = 0; i < headers.size(); i++) {
-        columnWidths[i] = std::max(columnWidths[i], headers[i].length());
-    }
-
-    for (const auto& row : data) {
-        for (size_t i = 0; i < row.size() && i < headers.size(); i++) {
-            columnWidths[i] = std::max(columnWidths[i], row[i].length());
-        }
-    }
-
-    // Выводим заголовки
-    std::cout << "\n";
-    for (size_t i = 0; i < headers.size(); i++) {
-        std::cout << std::left << std::setw(columnWidths[i] + 2) << headers[i];
-    }
-    std::cout << "\n";
-
-    // Линия под заголовками
-    for (size_t i = 0; i < headers.size(); i++) {
-        std::cout << std::string(columnWidths[i] + 2, '-');
-    }
-    std::cout << "\n";
-
-    // Выводим данные
-    for (const auto& row : data) {
-        for (size_t i = 0; i < row.size() && i < headers.size(); i++) {
-            std::cout << std::left << std::setw(columnWidths[i] + 2) << row[i];
-        }
-        std::cout << "\n";
-    }
-}
+#include "../include/AuditQueue.h"
+#include "../include/ProductCache.h"
+#include "../include/RepriceWorker.h"
+#include "../include/OrderColumns.h"
+#include "../include/TablePrinter.h"
 
 // Функция аутентификации
 std::shared_ptr<User> authenticateUser(
@@ -76,14 +40,12 @@ std::shared_ptr<User> authenticateUser(
     switch (choice) {
         case 1: {
             // Поиск администратора в БД
-            auto result = db->executeQuery(
+            auto result = db->query<int, std::string, std::string>(
                 "SELECT user_id, name, email FROM users WHERE role = 'admin' LIMIT 1"
             );
 
             if (!result.empty()) {
-                int id = std::stoi(result[0][0]);
-                std::string name = result[0][1];
-                std::string email = result[0][2];
+                auto [id, name, email] = result[0];
 
                 std::cout << "Вы вошли как Администратор: " << name << std::endl;
                 return std::make_shared<Admin>(id, name, email, db);
@@ -92,14 +54,12 @@ std::shared_ptr<User> authenticateUser(
         }
         case 2: {
             // Поиск менеджера в БД
-            auto result = db->executeQuery(
+            auto result = db->query<int, std::string, std::string>(
                 "SELECT user_id, name, email FROM users WHERE role = 'manager' LIMIT 1"
             );
 
             if (!result.empty()) {
-                int id = std::stoi(result[0][0]);
-                std::string name = result[0][1];
-                std::string email = result[0][2];
+                auto [id, name, email] = result[0];
 
                 std::cout << "Вы вошли как Менеджер: " << name << std::endl;
                 return std::make_shared<Manager>(id, name, email, db);
@@ -108,15 +68,12 @@ std::shared_ptr<User> authenticateUser(
         }
         case 3: {
             // Поиск покупателя в БД
-            auto result = db->executeQuery(
+            auto result = db->query<int, std::string, std::string, int>(
                 "SELECT user_id, name, email, loyalty_level FROM users WHERE role = 'customer' LIMIT 1"
             );
 
             if (!result.empty()) {
-                int id = std::stoi(result[0][0]);
-                std::string name = result[0][1];
-                std::string email = result[0][2];
-                int loyalty = std::stoi(result[0][3]);
+                auto [id, name, email, loyalty] = result[0];
 
                 std::cout << "Вы вошли как Покупатель: " << name;
                 if (loyalty == 1) {
@@ -140,6 +97,29 @@ std::shared_ptr<User> authenticateUser(
     return nullptr;
 }
 
+// Постраничный вывод списка: следующая страница запрашивается по курсору
+// только если пользователь ее просит
+void printPages(const std::function<Page(const std::optional<PageCursor>&)>& loadPage,
+                const std::vector<std::string>& headers) {
+    std::optional<PageCursor> cursor;
+
+    while (true) {
+        Page page = loadPage(cursor);
+        printTable(page.rows, headers);
+        if (!page.next) {
+            break;
+        }
+
+        std::cout << "Следующая страница? (y/n): ";
+        char answer;
+        std::cin >> answer;
+        if (answer != 'y' && answer != 'Y') {
+            break;
+        }
+        cursor = std::move(page.next);
+    }
+}
+
 // Меню администратора
 void showAdminMenu(std::shared_ptr<Admin> admin) {
     int choice;
@@ -158,7 +138,9 @@ void showAdminMenu(std::shared_ptr<Admin> admin) {
         std::cout << "7. Просмотреть историю статусов заказа\n";
         std::cout << "8. Просмотреть журнал аудита\n";
         std::cout << "9. Сформировать отчет (CSV)\n";
-        std::cout << "10. Выйти\n";
+        std::cout << "10. Сводка по заказам\n";
+        std::cout << "11. Задания пересчета цен\n";
+        std::cout << "12. Выйти\n";
         std::cout << "Ваш выбор: ";
         std::cin >> choice;
 
@@ -171,18 +153,21 @@ void showAdminMenu(std::shared_ptr<Admin> admin) {
         switch (choice) {
             case 1: {
                 std::string name;
-                double price;
+                std::string priceText;
                 int quantity;
 
                 std::cout << "Название товара: ";
                 std::cin.ignore();
                 std::getline(std::cin, name);
                 std::cout << "Цена: ";
-                std::cin >> price;
+                std::cin >> priceText;
                 std::cout << "Количество на складе: ";
                 std::cin >> quantity;
 
-                if (admin->addProduct(name, price, quantity)) {
+                auto price = Money::parse(priceText);
+                if (!price) {
+                    std::cout << "Неверный формат цены" << std::endl;
+                } else if (admin->addProduct(name, *price, quantity)) {
                     std::cout << "Товар успешно добавлен!" << std::endl;
                 } else {
                     std::cout << "Ошибка при добавлении товара" << std::endl;
@@ -192,7 +177,7 @@ void showAdminMenu(std::shared_ptr<Admin> admin) {
             case 2: {
                 int productId;
                 std::string name;
-                double price;
+                std::string priceText;
                 int quantity;
 
                 std::cout << "ID товара для обновления: ";
@@ -201,11 +186,14 @@ void showAdminMenu(std::shared_ptr<Admin> admin) {
                 std::cin.ignore();
                 std::getline(std::cin, name);
                 std::cout << "Новая цена: ";
-                std::cin >> price;
+                std::cin >> priceText;
                 std::cout << "Новое количество: ";
                 std::cin >> quantity;
 
-                if (admin->updateProduct(productId, name, price, quantity)) {
+                auto price = Money::parse(priceText);
+                if (!price) {
+                    std::cout << "Неверный формат цены" << std::endl;
+                } else if (admin->updateProduct(productId, name, *price, quantity)) {
                     std::cout << "Товар обновлен!" << std::endl;
                 } else {
                     std::cout << "Ошибка при обновлении товара" << std::endl;
@@ -225,8 +213,19 @@ void showAdminMenu(std::shared_ptr<Admin> admin) {
                 break;
             }
             case 4: {
-                auto orders = admin->viewAllOrders();
-                printTable(orders, {"ID заказа", "Клиент", "Статус", "Сумма", "Дата", "Товаров"});
+                // Все заказы выводятся потоково: ширина колонок фиксирована,
+                // строки печатаются по мере чтения из курсора
+                std::vector<std::string> headers = {"ID заказа", "Клиент", "Статус", "Сумма", "Дата", "Товаров"};
+                std::vector<size_t> widths = {10, 20, 12, 12, 26, 8};
+
+                printTableHeader(headers, widths);
+                size_t count = admin->streamAllOrders([&widths](const std::vector<std::string>& row) {
+                    printTableRow(row, widths);
+                });
+
+                if (count == 0) {
+                    std::cout << "Нет данных для отображения" << std::endl;
+                }
                 break;
             }
             case 5: {
@@ -244,13 +243,16 @@ void showAdminMenu(std::shared_ptr<Admin> admin) {
 
                 std::cout << "ID заказа: ";
                 std::cin >> orderId;
-                std::cout << "Новый статус (pending/completed/canceled/returned): ";
+                std::cout << "Новый статус (processing/completed/canceled/returned): ";
                 std::cin >> newStatus;
 
-                if (admin->updateOrderStatus(orderId, newStatus)) {
+                auto status = parseOrderStatus(newStatus);
+                if (!status) {
+                    std::cout << "Неизвестный статус" << std::endl;
+                } else if (auto result = admin->updateOrderStatus(orderId, *status)) {
                     std::cout << "Статус заказа обновлен!" << std::endl;
                 } else {
-                    std::cout << "Ошибка при обновлении статуса" << std::endl;
+                    std::cout << "Ошибка при обновлении статуса: " << result.message << std::endl;
                 }
                 break;
             }
@@ -259,15 +261,15 @@ void showAdminMenu(std::shared_ptr<Admin> admin) {
                 std::cout << "ID заказа: ";
                 std::cin >> orderId;
 
-                auto history = admin->db->executeQuery(
-                    "SELECT * FROM getOrderStatusHistory(" + std::to_string(orderId) + ")"
-                );
+                auto history = admin->getOrderStatusHistory(orderId);
                 printTable(history, {"ID", "Старый статус", "Новый статус", "Дата", "Кем изменен"});
                 break;
             }
             case 8: {
-                auto auditLog = admin->getAuditLog();
-                printTable(auditLog, {"ID", "Тип", "ID сущности", "Операция", "Кем", "Дата", "Детали"});
+                printPages([&admin](const std::optional<PageCursor>& after) {
+                               return admin->getAuditLog(30, 100, after);
+                           },
+                           {"ID", "Тип", "ID сущности", "Операция", "Кем", "Дата", "Детали"});
                 break;
             }
             case 9: {
@@ -278,14 +280,34 @@ void showAdminMenu(std::shared_ptr<Admin> admin) {
                 }
                 break;
             }
-            case 10:
+            case 10: {
+                OrderColumns snapshot = admin->loadOrderSnapshot();
+                auto counts = snapshot.countAllStatuses();
+
+                std::vector<std::vector<std::string>> summary;
+                for (std::size_t i = 0; i < ORDER_STATUS_COUNT; ++i) {
+                    OrderStatus status = static_cast<OrderStatus>(i);
+                    summary.push_back({std::string(toString(status)),
+                                       std::to_string(counts[i]),
+                                       snapshot.sumByStatus(status).toString()});
+                }
+                printTable(summary, {"Статус", "Заказов", "Сумма"});
+                std::cout << "Всего заказов: " << snapshot.size() << std::endl;
+                break;
+            }
+            case 11: {
+                auto jobs = admin->getRepriceJobs();
+                printTable(jobs, {"ID", "Товар", "Статус", "Готово", "Всего", "Создано", "Завершено"});
+                break;
+            }
+            case 12:
                 std::cout << "Выход из системы..." << std::endl;
                 break;
             default:
                 std::cout << "Неверный выбор!" << std::endl;
         }
 
-    } while (choice != 10);
+    } while (choice != 12);
 }
 
 // Меню менеджера
@@ -313,8 +335,10 @@ void showManagerMenu(std::shared_ptr<Manager> manager) {
 
         switch (choice) {
             case 1: {
-                auto orders = manager->getPendingOrders();
-                printTable(orders, {"ID заказа", "Клиент", "Сумма", "Дата", "Товаров"});
+                printPages([&manager](const std::optional<PageCursor>& after) {
+                               return manager->getPendingOrders(50, after);
+                           },
+                           {"ID заказа", "Клиент", "Сумма", "Дата", "Товаров"});
                 break;
             }
             case 2: {
@@ -322,10 +346,10 @@ void showManagerMenu(std::shared_ptr<Manager> manager) {
                 std::cout << "ID заказа для утверждения: ";
                 std::cin >> orderId;
 
-                if (manager->approveOrder(orderId)) {
+                if (auto result = manager->approveOrder(orderId)) {
                     std::cout << "Заказ утвержден!" << std::endl;
                 } else {
-                    std::cout << "Ошибка при утверждении заказа" << std::endl;
+                    std::cout << "Ошибка при утверждении заказа: " << result.message << std::endl;
                 }
                 break;
             }
@@ -336,10 +360,10 @@ void showManagerMenu(std::shared_ptr<Manager> manager) {
                 std::cout << "Новое количество: ";
                 std::cin >> quantity;
 
-                if (manager->updateStock(productId, quantity)) {
+                if (auto result = manager->updateStock(productId, quantity)) {
                     std::cout << "Количество товара обновлено!" << std::endl;
                 } else {
-                    std::cout << "Ошибка при обновлении количества" << std::endl;
+                    std::cout << "Ошибка при обновлении количества: " << result.message << std::endl;
                 }
                 break;
             }
@@ -361,10 +385,10 @@ void showManagerMenu(std::shared_ptr<Manager> manager) {
                 std::cout << "Новый статус: ";
                 std::cin >> newStatus;
 
-                if (manager->cancelOrder(orderId)) {
+                if (auto result = manager->cancelOrder(orderId)) {
                     std::cout << "Статус заказа изменен!" << std::endl;
                 } else {
-                    std::cout << "Ошибка при изменении статуса" << std::endl;
+                    std::cout << "Ошибка при изменении статуса: " << result.message << std::endl;
                 }
                 break;
             }
@@ -413,9 +437,7 @@ void showCustomerMenu(std::shared_ptr<Customer> customer) {
                 char addMore = 'y';
 
                 // Показываем доступные товары
-                auto availableProducts = customer->db->executeQuery(
-                    "SELECT product_id, name, price, stock_quantity FROM products WHERE stock_quantity > 0"
-                );
+                auto availableProducts = customer->getAvailableProducts();
 
                 std::cout << "\n=== ДОСТУПНЫЕ ТОВАРЫ ===\n";
                 printTable(availableProducts, {"ID", "Название", "Цена", "В наличии"});
@@ -434,7 +456,11 @@ void showCustomerMenu(std::shared_ptr<Customer> customer) {
                     std::cin >> addMore;
                 }
 
-                customer->createOrder(products);
+                if (auto result = customer->createOrder(products)) {
+                    std::cout << "Заказ успешно создан! " << result.message << std::endl;
+                } else {
+                    std::cout << "Ошибка при создании заказа: " << result.message << std::endl;
+                }
                 break;
             }
             case 2: {
@@ -447,10 +473,10 @@ void showCustomerMenu(std::shared_ptr<Customer> customer) {
                 std::cout << "Количество: ";
                 std::cin >> quantity;
 
-                if (customer->addToOrder(orderId, productId, quantity)) {
+                if (auto result = customer->addToOrder(orderId, productId, quantity)) {
                     std::cout << "Товар добавлен в заказ!" << std::endl;
                 } else {
-                    std::cout << "Ошибка при добавлении товара" << std::endl;
+                    std::cout << "Ошибка при добавлении товара: " << result.message << std::endl;
                 }
                 break;
             }
@@ -459,16 +485,18 @@ void showCustomerMenu(std::shared_ptr<Customer> customer) {
                 std::cout << "ID элемента заказа: ";
                 std::cin >> orderItemId;
 
-                if (customer->removeFromOrder(orderItemId)) {
+                if (auto result = customer->removeFromOrder(orderItemId)) {
                     std::cout << "Товар удален из заказа!" << std::endl;
                 } else {
-                    std::cout << "Ошибка при удалении товара" << std::endl;
+                    std::cout << "Ошибка при удалении товара: " << result.message << std::endl;
                 }
                 break;
             }
             case 4: {
-                auto orders = customer->getMyOrderHistory();
-                printTable(orders, {"ID заказа", "Статус", "Сумма", "Дата", "Товаров"});
+                printPages([&customer](const std::optional<PageCursor>& after) {
+                               return customer->getMyOrderHistory(20, after);
+                           },
+                           {"ID заказа", "Статус", "Сумма", "Дата", "Товаров"});
                 break;
             }
             case 5: {
@@ -543,10 +571,10 @@ void showCustomerMenu(std::shared_ptr<Customer> customer) {
                 }
 
                 // Создаем заказ и оплачиваем его
-                if (customer->makePayment(orderId, paymentMethod)) {
+                if (auto result = customer->makePayment(orderId, paymentMethod)) {
                     std::cout << "Заказ успешно оплачен!" << std::endl;
                 } else {
-                    std::cout << "Ошибка при оплате заказа" << std::endl;
+                    std::cout << "Ошибка при оплате заказа: " << result.message << std::endl;
                 }
                 break;
             }
@@ -555,10 +583,10 @@ void showCustomerMenu(std::shared_ptr<Customer> customer) {
                 std::cout << "ID заказа для возврата: ";
                 std::cin >> orderId;
 
-                if (customer->returnOrder(orderId)) {
+                if (auto result = customer->returnOrder(orderId)) {
                     std::cout << "Заказ успешно возвращен!" << std::endl;
                 } else {
-                    std::cout << "Нельзя вернуть этот заказ" << std::endl;
+                    std::cout << "Нельзя вернуть этот заказ: " << result.message << std::endl;
                 }
                 break;
             }
@@ -585,8 +613,14 @@ int main() {
         "password=***";
 
     try {
+        // ПУЛ СОЕДИНЕНИЙ: пара соединений сразу, остальные по требованию
+        PoolOptions poolOptions;
+        poolOptions.initialSize = 2;
+        poolOptions.maxSize = 8;
+        poolOptions.waitTimeout = std::chrono::seconds(5);
+
         //ИСПОЛЬЗОВАНИЕ УМНЫХ УКАЗАТЕЛЕЙ
-        auto db = std::make_shared<DatabaseConnection<std::string>>(connectionString);
+        auto db = std::make_shared<DatabaseConnection<std::string>>(connectionString, poolOptions);
 
         if (!db->isConnected()) {
             std::cerr << "Не удалось подключиться к базе данных!" << std::endl;
@@ -595,6 +629,21 @@ int main() {
 
         std::cout << "Успешное подключение к базе данных!\n";
 
+        // Регистрируем подготовленные запросы для всех ролей
+        User::registerStatements(*db);
+
+        // Секции журналов обслуживает OnlineStoreServer по расписанию
+        // (PartitionMaintainer), консольный клиент их не трогает
+
+        // Аудит пишется фоновым потоком пакетами, не задерживая операции
+        auto auditQueue = std::make_shared<AuditQueue>(db);
+
+        // Каталог товаров в памяти, инвалидация через LISTEN/NOTIFY
+        auto productCache = std::make_shared<ProductCache>(db);
+
+        // Крупные пересчеты цен заказов выполняются в фоне (reprice_jobs)
+        RepriceWorker repriceWorker(db);
+
         // Главный цикл программы
         while (true) {
             auto user = authenticateUser(db);
@@ -604,6 +653,9 @@ int main() {
                 break;
             }
 
+            user->setAuditQueue(auditQueue);
+            user->setProductCache(productCache);
+
             // Показываем соответствующее меню в зависимости от роли
             std::string role = user->getRole();
 
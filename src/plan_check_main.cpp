@@ -0,0 +1,288 @@
+// src/plan_check_main.cpp
+// Проверка планов запросов приложения на тестовых данных.
+// Текст запросов не копируется: подготовленные запросы берутся из
+// User::registerStatements и проверяются через EXPLAIN EXECUTE, тела
+// функций и триггеров - модулем auto_explain при настоящем вызове.
+// Завершается с кодом 1, если в плане есть Seq Scan по большой таблице.
+//
+// Запуск: OnlineStorePlanCheck [файл тестовых данных]
+// (по умолчанию sql/plan_check.sql). Строка подключения - STORE_DSN.
+// Нужны схема, database_setup.sql и право LOAD 'auto_explain'
+// (суперпользователь). Все изменения откатываются.
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../include/DatabaseConnection.h"
+#include "../include/User.h"
+
+namespace {
+    // Планы auto_explain приходят клиенту уведомлениями (NOTICE)
+    class PlanCollector : public pqxx::errorhandler {
+    public:
+        explicit PlanCollector(pqxx::connection& conn) : pqxx::errorhandler(conn) {}
+
+        bool operator()(const char message[]) noexcept override {
+            std::string_view text(message);
+            auto marker = text.find("plan:");
+            auto begin = text.find('{', marker == std::string_view::npos ? 0 : marker);
+            auto end = text.rfind('}');
+            if (marker == std::string_view::npos || begin == std::string_view::npos ||
+                end == std::string_view::npos || end < begin) {
+                return true;   // Обычное уведомление - выводится как обычно
+            }
+            try {
+                plans.emplace_back(text.substr(begin, end - begin + 1));
+            } catch (...) {
+            }
+            return false;
+        }
+
+        std::vector<std::string> plans;
+    };
+
+    // Таблицы, которые план читает последовательно. Секция журнала
+    // учитывается как ее родительская таблица; маленькие секции (меньше
+    // 10000 строк) разрешено читать целиком
+    const char* SEQ_SCAN_SQL =
+        "SELECT DISTINCT COALESCE(parent.relname, rel.relname) "
+        "FROM jsonb_path_query($1::jsonb, "
+        "'$.** ? (@.\"Node Type\" == \"Seq Scan\").\"Relation Name\"') AS node "
+        "JOIN pg_class rel ON rel.relname = node #>> '{}' "
+        "LEFT JOIN pg_inherits i ON i.inhrelid = rel.oid "
+        "LEFT JOIN pg_class parent ON parent.oid = i.inhparent "
+        "WHERE parent.oid IS NULL OR rel.reltuples >= 10000";
+
+    class PlanChecker {
+    public:
+        PlanChecker(pqxx::work& tx, PlanCollector& collector)
+            : tx(tx), collector(collector) {}
+
+        // Подготовленный запрос приложения: EXPLAIN EXECUTE без выполнения
+        void statement(const std::string& name, const std::string& args,
+                       const std::vector<std::string>& forbidden) {
+            run(name, forbidden, [&] {
+                pqxx::result res = tx.exec("EXPLAIN (FORMAT JSON) EXECUTE " + name + "(" + args + ")");
+                return std::vector<std::string>{res[0][0].c_str()};
+            });
+        }
+
+        // Вызов с вложенными запросами (функции, триггеры): выполняется
+        // под auto_explain и откатывается к точке сохранения
+        void nested(const std::string& name, const std::string& sql,
+                    const std::vector<std::string>& forbidden) {
+            run(name, forbidden, [&] {
+                tx.exec("SAVEPOINT plan_check");
+                collector.plans.clear();
+                tx.exec("SET LOCAL auto_explain.log_min_duration = 0");
+                tx.exec(sql);
+                tx.exec("SET LOCAL auto_explain.log_min_duration = -1");
+                tx.exec("ROLLBACK TO SAVEPOINT plan_check");
+                return collector.plans;
+            });
+        }
+
+        // Запрос из тела процедуры, которую нельзя вызвать в транзакции
+        // (сама делает COMMIT). Текст сверяется с телом процедуры, поэтому
+        // копия не устаревает незаметно; placeholders - значения параметров
+        void procedureQuery(const std::string& name, const std::string& procedure,
+                            const std::string& body,
+                            const std::vector<std::pair<std::string, std::string>>& placeholders,
+                            const std::vector<std::string>& forbidden) {
+            run(name, forbidden, [&]() -> std::vector<std::string> {
+                pqxx::result found = tx.exec_params(
+                    "SELECT position(regexp_replace($1, '\\s+', ' ', 'g') IN "
+                    "regexp_replace(pg_get_functiondef(to_regprocedure($2)), '\\s+', ' ', 'g')) > 0",
+                    body, procedure);
+                if (!found[0][0].as<bool>()) {
+                    throw std::runtime_error("запрос не найден в теле " + procedure);
+                }
+
+                std::string sql = body;
+                for (const auto& [from, to] : placeholders) {
+                    for (auto pos = sql.find(from); pos != std::string::npos;
+                         pos = sql.find(from, pos + to.size())) {
+                        sql.replace(pos, from.size(), to);
+                    }
+                }
+                pqxx::result res = tx.exec("EXPLAIN (FORMAT JSON) " + sql);
+                return {res[0][0].c_str()};
+            });
+        }
+
+        int failures() const { return failed; }
+
+    private:
+        pqxx::work& tx;
+        PlanCollector& collector;
+        int failed = 0;
+
+        template<typename Explain>
+        void run(const std::string& name, const std::vector<std::string>& forbidden,
+                 Explain&& explain) {
+            std::vector<std::string> scans;
+            try {
+                tx.exec("SAVEPOINT plan_explain");
+                for (const auto& plan : explain()) {
+                    for (const auto& row : tx.exec_params(SEQ_SCAN_SQL, plan)) {
+                        scans.emplace_back(row[0].c_str());
+                    }
+                }
+                tx.exec("RELEASE SAVEPOINT plan_explain");
+            } catch (const std::exception& e) {
+                tx.exec("ROLLBACK TO SAVEPOINT plan_explain");
+                std::cout << "FAIL: " << name << ": " << e.what() << std::endl;
+                ++failed;
+                return;
+            }
+
+            std::string bad;
+            for (const auto& table : scans) {
+                for (const auto& f : forbidden) {
+                    if (table == f && bad.find(table) == std::string::npos) {
+                        bad += (bad.empty() ? "" : ", ") + table;
+                    }
+                }
+            }
+            if (bad.empty()) {
+                std::cout << "OK:   " << name << std::endl;
+            } else {
+                std::cout << "FAIL: " << name << ": Seq Scan on " << bad << std::endl;
+                ++failed;
+            }
+        }
+    };
+
+    std::string readFile(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Не удалось открыть " + path);
+        }
+        std::ostringstream text;
+        text << in.rdbuf();
+        return text.str();
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* dsn = std::getenv("STORE_DSN");
+    if (!dsn) {
+        std::cerr << "Задайте строку подключения в STORE_DSN" << std::endl;
+        return 2;
+    }
+    std::string seedPath = argc > 1 ? argv[1] : "sql/plan_check.sql";
+
+    try {
+        // Реестр запросов приложения - тот же, что у OnlineStore и сервера
+        PoolOptions poolOptions;
+        poolOptions.maxSize = 1;
+        DatabaseConnection<std::string> db(dsn, poolOptions);
+        User::registerStatements(db);
+
+        auto conn = db.openDedicatedConnection();
+        for (const auto& [name, sql] : db.getStatements()) {
+            conn->prepare(name, sql);
+        }
+        PlanCollector collector(*conn);
+
+        pqxx::work tx(*conn);
+        tx.exec(readFile(seedPath));
+
+        tx.exec("LOAD 'auto_explain'");
+        tx.exec("SET LOCAL auto_explain.log_format = 'json'");
+        tx.exec("SET LOCAL auto_explain.log_level = 'notice'");
+        tx.exec("SET LOCAL auto_explain.log_nested_statements = on");
+        tx.exec("SET LOCAL auto_explain.log_min_duration = -1");
+
+        pqxx::row ids = tx.exec1(
+            "SELECT u.ids[1], o.first_id, p.ids[1], s.product_id "
+            "FROM plan_users u, plan_orders o, plan_products p, plan_small_product s");
+        std::string user = ids[0].c_str();
+        std::string order = ids[1].c_str();
+        std::string product = ids[2].c_str();
+        std::string smallProduct = ids[3].c_str();
+        std::string past = "CURRENT_TIMESTAMP - INTERVAL '100 days'";
+
+        PlanChecker check(tx, collector);
+
+        // ПОДГОТОВЛЕННЫЕ ЗАПРОСЫ (src/User.cpp)
+        check.statement("order_status_by_owner", order + ", " + user, {"orders"});
+        check.statement("order_item_owner_check", "1, " + user, {"orders", "order_items"});
+        check.statement("order_item_add_guarded", order + ", " + product + ", 1, " + user,
+                        {"orders", "order_items", "products"});
+        check.statement("order_return_guarded", order + ", " + user, {"orders"});
+        check.statement("orders_all_first", "51", {"orders"});
+        check.statement("orders_all_next", past + ", " + order + ", 51", {"orders"});
+        check.statement("orders_by_user_first", user + ", 21", {"orders"});
+        check.statement("orders_by_user_next", user + ", " + past + ", " + order + ", 21",
+                        {"orders"});
+        check.statement("orders_pending_first", "51", {"orders"});
+        check.statement("orders_pending_next", past + ", " + order + ", 51", {"orders"});
+        check.statement("orders_approved_by_manager", user, {"audit_log", "orders"});
+        check.statement("audit_recent_first", "30, 101", {"audit_log"});
+        check.statement("audit_recent_next",
+                        "30, CURRENT_TIMESTAMP - INTERVAL '1 day', 1000000000, 101",
+                        {"audit_log"});
+
+        // ФУНКЦИИ И ТРИГГЕРЫ (sql/database_setup.sql)
+        check.nested("getAuditLogByUser", "EXECUTE audit_by_user(" + user + ")", {"audit_log"});
+        check.nested("getOrderStatusHistory", "EXECUTE order_status_history(" + order + ")",
+                     {"order_status_history"});
+        check.nested("getUserOrderCount", "SELECT getUserOrderCount(" + user + ")",
+                     {"orders", "user_order_stats"});
+        check.nested("getTotalSpentByUser", "SELECT getTotalSpentByUser(" + user + ")",
+                     {"orders", "user_order_stats"});
+        check.nested("generateAuditReport",
+                     "SELECT * FROM generateAuditReport(CURRENT_DATE - 3, CURRENT_DATE)",
+                     {"orders", "audit_log", "order_status_history"});
+        // Триггер trg_update_order_prices: пересчет сразу (мало позиций)
+        // и постановка задания (много позиций)
+        check.nested("trg_update_order_prices_inline",
+                     "UPDATE products SET price = price + 1 WHERE product_id = " + smallProduct,
+                     {"order_items", "orders"});
+        check.nested("trg_update_order_prices_job",
+                     "UPDATE products SET price = price + 1 WHERE product_id = " + product,
+                     {"order_items", "orders"});
+
+        // processRepriceJobs делает COMMIT и в транзакции проверки не вызывается
+        std::vector<std::pair<std::string, std::string>> jobParams = {
+            {"job.product_id", product}, {"batch_size", "500"}};
+        check.procedureQuery("processRepriceJobs_batch", "processrepricejobs(integer)",
+            "SELECT oi.order_item_id, oi.price AS old_price "
+            "FROM order_items oi "
+            "JOIN orders o ON o.order_id = oi.order_id "
+            "JOIN products p ON p.product_id = oi.product_id "
+            "WHERE oi.product_id = job.product_id "
+            "AND o.status = 'pending' "
+            "AND oi.price <> p.price "
+            "ORDER BY oi.order_item_id "
+            "LIMIT batch_size "
+            "FOR UPDATE OF oi, o",
+            jobParams, {"order_items", "orders"});
+        check.procedureQuery("processRepriceJobs_remaining", "processrepricejobs(integer)",
+            "SELECT COUNT(*) "
+            "FROM order_items oi "
+            "JOIN orders o ON o.order_id = oi.order_id "
+            "JOIN products p ON p.product_id = oi.product_id "
+            "WHERE oi.product_id = job.product_id "
+            "AND o.status = 'pending' "
+            "AND oi.price <> p.price",
+            jobParams, {"order_items", "orders"});
+
+        tx.abort();
+
+        if (check.failures() > 0) {
+            std::cout << "Ошибок: " << check.failures() << std::endl;
+            return 1;
+        }
+        std::cout << "Все планы используют индексы" << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Проверка не выполнена: " << e.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,116 @@
+// src/server_main.cpp
+// Сетевой сервер магазина: многие пользователи одновременно вместо
+// одного консольного меню. Протокол описан в include/StoreServer.h.
+//
+// Запуск: OnlineStoreServer [порт] [рабочих потоков]
+// Строка подключения к БД - переменная STORE_DSN.
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "../include/DatabaseConnection.h"
+#include "../include/User.h"
+#include "../include/AuditQueue.h"
+#include "../include/ProductCache.h"
+#include "../include/RepriceWorker.h"
+#include "../include/PartitionMaintainer.h"
+#include "../include/StoreServer.h"
+
+namespace {
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    // Верхняя граница числа рабочих потоков (и соединений пула под них)
+    const int MAX_WORKERS = 256;
+
+    // Фоновые компоненты, которые берут соединения из общего пула:
+    // поток записи AuditQueue, PartitionMaintainer и перезагрузка каталога
+    // ProductCache. RepriceWorker и подписка кэша (LISTEN) открывают
+    // собственные соединения вне пула и здесь не учитываются
+    const std::size_t BACKGROUND_POOL_USERS = 3;
+
+    void onStopSignal(int) {
+        stopRequested = 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* dsn = std::getenv("STORE_DSN");
+    if (!dsn) {
+        std::cerr << "Задайте строку подключения в STORE_DSN, например:\n"
+                  << "  STORE_DSN=\"host=localhost dbname=online_store\" "
+                  << argv[0] << " [порт] [потоков]" << std::endl;
+        return 1;
+    }
+
+    ServerOptions serverOptions;
+    try {
+        int port = argc > 1 ? std::stoi(argv[1]) : serverOptions.port;
+        int workers = argc > 2
+            ? std::stoi(argv[2])
+            : static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+        if (port <= 0 || port > 65535 || workers <= 0 || workers > MAX_WORKERS) {
+            throw std::out_of_range("server arguments");
+        }
+        serverOptions.port = static_cast<std::uint16_t>(port);
+        serverOptions.workers = static_cast<std::size_t>(workers);
+    } catch (const std::exception&) {
+        std::cerr << "Некорректный порт (1-65535) или число потоков (1-"
+                  << MAX_WORKERS << ")" << std::endl;
+        return 1;
+    }
+
+    // Запись в закрытый клиентом сокет не должна завершать процесс
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    try {
+        // ПУЛ СОЕДИНЕНИЙ: по соединению на рабочий поток и на каждого
+        // фонового пользователя пула, чтобы запрос не ждал соединения
+        PoolOptions poolOptions;
+        poolOptions.initialSize = serverOptions.workers;
+        poolOptions.maxSize = serverOptions.workers + BACKGROUND_POOL_USERS;
+        poolOptions.waitTimeout = std::chrono::seconds(5);
+
+        auto db = std::make_shared<DatabaseConnection<std::string>>(dsn, poolOptions);
+        if (!db->isConnected()) {
+            std::cerr << "Не удалось подключиться к базе данных!" << std::endl;
+            return 1;
+        }
+
+        User::registerStatements(*db);
+
+        auto auditQueue = std::make_shared<AuditQueue>(db);
+        auto productCache = std::make_shared<ProductCache>(db);
+        RepriceWorker repriceWorker(db);
+
+        // Секции журналов: при старте и затем по расписанию
+        PartitionMaintainer partitionMaintainer(db);
+
+        StoreServer server(db, auditQueue, productCache, serverOptions);
+        if (!server.start()) {
+            return 1;
+        }
+
+        std::cout << "Сервер запущен на порту " << serverOptions.port
+                  << " (Ctrl+C - остановка)" << std::endl;
+
+        while (!stopRequested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        std::cout << "Остановка сервера..." << std::endl;
+        server.stop();
+
+    } catch (const std::exception& e) {
+        std::cerr << "Критическая ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}